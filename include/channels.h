@@ -0,0 +1,121 @@
+#pragma once
+
+#include "datas.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace px4ctrl {
+namespace ui {
+
+// Plottable ServerPayload fields: (id, member, element index, name, unit).
+// Add a line here to make a field available to history and plots; channels
+// nobody plots cost one table entry and nothing else.
+#define PX4_TELEMETRY_CHANNELS(X)                                              \
+  X(POS_X, pos, 0, "pos.x", "m")                                               \
+  X(POS_Y, pos, 1, "pos.y", "m")                                               \
+  X(POS_Z, pos, 2, "pos.z", "m")                                               \
+  X(VEL_X, vel, 0, "vel.x", "m/s")                                             \
+  X(VEL_Y, vel, 1, "vel.y", "m/s")                                             \
+  X(VEL_Z, vel, 2, "vel.z", "m/s")                                             \
+  X(SPEED, speed_norm, 0, "speed", "m/s")                                      \
+  X(OMEGA_X, omega, 0, "omega.x", "rad/s")                                     \
+  X(OMEGA_Y, omega, 1, "omega.y", "rad/s")                                     \
+  X(OMEGA_Z, omega, 2, "omega.z", "rad/s")                                     \
+  X(ROLL, roll_deg, 0, "roll", "deg")                                          \
+  X(PITCH, pitch_deg, 0, "pitch", "deg")                                       \
+  X(YAW, yaw_deg, 0, "yaw", "deg")                                             \
+  X(TILT, tilt_deg, 0, "tilt", "deg")                                          \
+  X(THRUST_SP, thrust_setpoint, 0, "thrust_sp", "")                            \
+  X(OMEGA_SP_X, omega_setpoint, 0, "omega_sp.x", "rad/s")                      \
+  X(OMEGA_SP_Y, omega_setpoint, 1, "omega_sp.y", "rad/s")                      \
+  X(OMEGA_SP_Z, omega_setpoint, 2, "omega_sp.z", "rad/s")                      \
+  X(BATTERY_V, battery_voltage, 0, "battery", "V")                             \
+  X(BATTERY_PCT, battery_remaining, 0, "battery_remaining", "")                \
+  X(ODOM_HZ, odom_hz, 0, "odom_hz", "Hz")                                      \
+  X(ODOM_AGE, odom_age_ms, 0, "odom_age", "ms")                                \
+  X(CMDCTRL_HZ, cmdctrl_hz, 0, "cmdctrl_hz", "Hz")                             \
+  X(CMD_AGE, cmd_age_ms, 0, "cmd_age", "ms")                                   \
+  X(CLIENT_CMD_AGE, client_cmd_age_ms, 0, "client_cmd_age", "ms")              \
+  X(MISSION_PHASE, mission_phase, 0, "mission_phase", "")
+
+enum class ChannelId : uint8_t {
+#define PX4_CHANNEL_ID(id, member, index, name, unit) id,
+  PX4_TELEMETRY_CHANNELS(PX4_CHANNEL_ID)
+#undef PX4_CHANNEL_ID
+};
+
+enum class FieldType : uint8_t { F32, F64, I32, U8, U32, U64 };
+
+template <typename T> constexpr FieldType field_type() {
+  if constexpr (std::is_same_v<T, float>) return FieldType::F32;
+  else if constexpr (std::is_same_v<T, double>) return FieldType::F64;
+  else if constexpr (std::is_same_v<T, int32_t>) return FieldType::I32;
+  else if constexpr (std::is_same_v<T, uint8_t>) return FieldType::U8;
+  else if constexpr (std::is_same_v<T, uint32_t>) return FieldType::U32;
+  else if constexpr (std::is_same_v<T, uint64_t>) return FieldType::U64;
+  else static_assert(sizeof(T) == 0, "Unsupported telemetry channel field type");
+}
+
+struct ChannelInfo {
+  ChannelId id;
+  const char *name;
+  const char *unit;
+  size_t offset; // byte offset of the element inside ServerPayload
+  FieldType type;
+
+  [[nodiscard]] float read(const ServerPayload &p) const {
+    const auto *src = reinterpret_cast<const uint8_t *>(&p) + offset;
+    switch (type) {
+    case FieldType::F32: return load<float>(src);
+    case FieldType::F64: return static_cast<float>(load<double>(src));
+    case FieldType::I32: return static_cast<float>(load<int32_t>(src));
+    case FieldType::U8: return static_cast<float>(load<uint8_t>(src));
+    case FieldType::U32: return static_cast<float>(load<uint32_t>(src));
+    case FieldType::U64: return static_cast<float>(load<uint64_t>(src));
+    }
+    return 0.0F;
+  }
+
+private:
+  template <typename T> static T load(const uint8_t *src) {
+    T v;
+    std::memcpy(&v, src, sizeof(T));
+    return v;
+  }
+};
+
+#define PX4_CHANNEL_INFO(id, member, index, name, unit)                        \
+  ChannelInfo{ChannelId::id, name, unit,                                       \
+              offsetof(ServerPayload, member) +                                \
+                  (index) * sizeof(std::remove_extent_t<                       \
+                                   decltype(ServerPayload::member)>),          \
+              field_type<std::remove_extent_t<decltype(ServerPayload::member)>>()},
+
+inline constexpr ChannelInfo kChannels[] = {PX4_TELEMETRY_CHANNELS(PX4_CHANNEL_INFO)};
+#undef PX4_CHANNEL_INFO
+
+inline constexpr size_t kChannelCount = std::size(kChannels);
+
+constexpr bool channel_table_ordered() {
+  for (size_t i = 0; i < kChannelCount; ++i) {
+    if (static_cast<size_t>(kChannels[i].id) != i) return false;
+  }
+  return true;
+}
+static_assert(channel_table_ordered(), "kChannels must be indexable by ChannelId");
+static_assert(kChannelCount <= 64, "Channel masks are 64-bit");
+
+constexpr const ChannelInfo &channel_info(ChannelId id) {
+  return kChannels[static_cast<size_t>(id)];
+}
+
+constexpr uint64_t channel_bit(ChannelId id) {
+  return uint64_t{1} << static_cast<size_t>(id);
+}
+
+} // namespace ui
+} // namespace px4ctrl
@@ -4,8 +4,18 @@
 #define ZENOH_LINUX 1
 #endif
 
+#include "control.h"
 #include "datas.h"
+#include "dispatch.h"
+#include "gl_lines.h"
+#include "gl_scene.h"
+#include "group.h"
+#include "history.h"
+#include "plot_geometry.h"
+#include "redraw.h"
+#include "trajectory.h"
 #include "types.h"
+#include "wire_schema.h"
 
 #include <imgui.h>
 #include <array>
@@ -14,7 +24,9 @@
 #include <cstdint>
 #include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <spdlog/common.h>
 #include <string>
 #include <vector>
@@ -23,6 +35,13 @@
 namespace px4ctrl {
 namespace ui {
 
+// A ServerPayload as posted to observers: stamped with steady_ns() on the
+// zenoh thread as it arrives, so time spent waiting in observer queues is not
+// mistaken for network delay.
+struct ServerSample : ServerPayload {
+  int64_t arrival_ns = 0;
+};
+
 class Px4Client {
 public:
   struct LogEntry {
@@ -33,9 +52,21 @@ public:
   explicit Px4Client(const TransportParas &paras);
   ~Px4Client();
 
-  Px4Data<ServerPayload> server_data;
-  Px4Data<LogEntry> log_data;
+private:
+  // Declared before the observables that dispatch onto it, so it is joined
+  // after they are gone and never by one of its own workers.
+  std::unique_ptr<ThreadPool> observer_pool_;
+
+public:
+  Px4KeyedData<ServerSample, &ServerSample::id> server_data; // keyed by drone id
+  Px4AsyncData<LogEntry> log_data;
+  Px4AsyncData<TrajectoryAck> trajectory_ack;
+  Px4AsyncData<GroupAck> group_ack;
   void pub_client(const ClientPayload &payload);
+  // One encode_trajectory() chunk.
+  void pub_trajectory(const std::vector<uint8_t> &chunk);
+  // One encode_group_command() message.
+  void pub_group(const std::vector<uint8_t> &message);
   [[nodiscard]] const TransportParas &transport_paras() const { return paras_; }
 
 private:
@@ -44,6 +75,10 @@ private:
   z_owned_publisher_t client_pub_{};
   z_owned_subscriber_t server_sub_{};
   z_owned_subscriber_t log_sub_{};
+  z_owned_publisher_t trajectory_pub_{};
+  z_owned_subscriber_t trajectory_ack_sub_{};
+  z_owned_publisher_t group_pub_{};
+  z_owned_subscriber_t group_ack_sub_{};
 
   std::atomic<bool> ok_{false};
 
@@ -52,27 +87,118 @@ private:
 
   static void server_sample_callback(z_loaned_sample_t *sample, void *context);
   static void log_sample_callback(z_loaned_sample_t *sample, void *context);
+  static void trajectory_ack_callback(z_loaned_sample_t *sample, void *context);
+  static void group_ack_callback(z_loaned_sample_t *sample, void *context);
 };
 
 class ImguiClient {
 public:
   explicit ImguiClient(Px4Client &px4_client);
   void render_window();
+  void set_window_visible(bool visible) { window_visible_ = visible; }
+  // Latest gamepad state, sampled by the platform layer once per frame.
+  void set_gamepad(const GamepadSample &pad) { gamepad_ = pad; }
+  // Paces the UI loop; telemetry and log arrivals call notify(), telemetry
+  // with its zenoh-thread arrival stamp.
+  RedrawScheduler &redraw() { return redraw_; }
+  // GPU line plots and 3D view; both need the GL context current. Without
+  // init_gl() plots are tessellated by ImGui and the 3D view is disabled.
+  bool init_gl() {
+    const bool lines = gl_lines_.init();
+    const bool scene = gl_scene_.init();
+    return lines && scene;
+  }
+  void shutdown_gl() {
+    gl_lines_.shutdown();
+    gl_scene_.shutdown();
+  }
 
 private:
   struct TelemetryHistory {
-    std::deque<float> x;
-    std::deque<float> y;
-    std::deque<float> z;
-    std::deque<ImVec2> xy_trace;
-
-    std::deque<float> thrust;
-    std::deque<float> omega_x;
-    std::deque<float> omega_y;
-    std::deque<float> omega_z;
-    std::deque<ImVec2> omega_xy_trace;
-
-    void push(const ServerPayload &p, size_t max_points);
+    TelemetryRing raw{1200}; // sample/arrival time (s) + raw channels
+
+    // Min/max/mean pyramid over the same channels, 10x/100x/1000x coarser.
+    std::array<PyramidLevel, 3> levels{{{10, 1200}, {100, 1200}, {1000, 1200}}};
+
+    // Positions at up to kTrailHz for the 3D view (10 minutes).
+    static constexpr double kTrailHz = 10.0;
+    TelemetryRing trail{6000};
+    double trail_due = 0.0; // writer only
+
+    uint64_t version = 0; // bumped on every push
+    SampleClock clock;
+
+    // Records the channels in `wanted` (channel_bit mask), enabling any new
+    // ones from this sample on. Arrival times are seconds since `epoch_ns`.
+    void push(const ServerSample &p, int64_t epoch_ns, uint64_t wanted);
+    void sync_from(const TelemetryHistory &src);
+  };
+
+  struct PlotCaches {
+    std::array<PlotGeometryCache, kChannelCount> line;
+    std::array<PlotGeometryCache, kChannelCount> envelope;
+    PlotGeometryCache xy;
+  };
+
+  struct TelemetryRateState {
+    TelemetryTier tier = TelemetryTier::FOCUSED;
+    float rate_hz = -1.0F;
+    clock::time_point sent_at{};
+  };
+
+  // Chunked trajectory upload in flight or finished, per drone. Written by
+  // the render thread and the ack observer, under data_mutex_.
+  struct TrajectoryUploadState {
+    enum class Phase : uint8_t { IDLE, SENDING, COMPLETE, REJECTED, FAILED };
+    Phase phase = Phase::IDLE;
+    uint32_t upload_id = 0;
+    std::shared_ptr<const std::vector<std::vector<uint8_t>>> chunks;
+    size_t points = 0;
+    size_t messages = 0; // chunk messages published, resends included
+    uint16_t next_seq = 0; // first chunk the server still misses
+    int retries = 0;
+    clock::time_point started_at{};
+    clock::time_point last_activity{}; // last send or ack
+    double complete_ms = -1.0; // first send to COMPLETE ack
+  };
+
+  // Path being drawn or imported in the trajectory popup; render thread only.
+  struct PathEditorState {
+    std::vector<TrajectoryPoint> points;
+    float altitude = 1.5F;
+    float speed = 1.0F;   // m/s, times drawn and untimed imported paths
+    float extent = 10.0F; // canvas half width, m
+    std::array<float, 2> center{};
+    bool centered = false;
+    bool start_on_complete = true;
+    char csv_path[256] = "";
+    std::string csv_error;
+  };
+
+  // Fleet-wide command in flight or finished. Written by the render thread
+  // and the group ack observer, under data_mutex_.
+  struct GroupCommandState {
+    GroupCommandHeader header{};
+    std::vector<GroupMember> members;
+    std::map<uint8_t, double> ack_ms; // click to ack, per member
+    std::set<uint8_t> rejected;
+    clock::time_point clicked_at{};
+    clock::time_point last_send{};
+    double publish_ms = 0.0;    // click to publish returned
+    double all_acked_ms = -1.0; // click to the last member's ack
+    size_t messages = 0;        // resends included
+    int retries = 0;
+    bool failed = false; // retries exhausted with members missing
+  };
+
+  // Group command panel inputs; render thread only.
+  struct GroupEditorState {
+    std::set<uint8_t> selection;
+    Formation formation = Formation::OFFSETS;
+    std::array<float, 4> anchor{0.0F, 0.0F, 1.5F, 0.0F};
+    float spacing = 2.0F; // m, template formations
+    // Hover targets relative to the anchor, recorded by "From current".
+    std::map<uint8_t, std::array<float, 4>> offsets;
   };
 
   struct SafetyEditorState {
@@ -87,32 +213,84 @@ private:
   };
 
   std::map<uint8_t, ServerPayload> server_data_map_;
-  std::map<uint8_t, TelemetryHistory> history_map_;
+  // Inserted under data_mutex_ and then written only by that drone's history
+  // observer; nodes are never erased, so the renderer can read snapshots
+  // without holding data_mutex_.
+  std::map<uint8_t, SnapshotStore<TelemetryHistory>> history_map_;
   std::map<uint8_t, SafetyEditorState> safety_editor_map_;
+  std::map<uint8_t, TrajectoryUploadState> trajectory_upload_map_;
+  std::map<uint8_t, PathEditorState> path_editor_map_;
+  uint32_t next_upload_id_ = 1;
+  std::deque<GroupCommandState> group_commands_; // newest first
+  GroupEditorState group_editor_;
+  uint32_t next_group_seq_ = 1;
   std::map<uint8_t, std::array<float, 4>> hover_input_map_;
-  Px4DataObserver log_observer_;
-  Px4DataObserver server_observer_;
+  std::map<uint8_t, TelemetryRateState> telemetry_rate_map_;
+  std::map<uint8_t, bool> section_visible_map_;
+  std::map<uint8_t, float> section_height_map_; // last built height, for culled sections
+  // Panels built vs skipped as off-screen, counted per frame.
+  struct CullStats {
+    int sections_drawn = 0;
+    int sections_culled = 0;
+    int tiles_drawn = 0;
+    int tiles_culled = 0;
+    int plots_drawn = 0;
+    int plots_culled = 0;
+  };
+  CullStats cull_stats_;      // frame being built
+  CullStats last_cull_stats_; // previous complete frame
+  std::map<uint8_t, PlotCaches> plot_cache_map_; // render thread only
+  GlLineRenderer gl_lines_;                      // render thread only
+  GlSceneRenderer gl_scene_;                     // render thread only
+  GlSceneRenderer::Camera scene_camera_;
+  std::vector<GlSceneRenderer::Drone> scene_drones_;
+  bool show_scene_ = false;
+  // One compact tile per drone; only the focused drone gets full panels.
+  bool fleet_view_ = true;
+  std::vector<ImVec2> spark_points_; // tile sparkline scratch
+  bool scene_follow_ = true; // keep the camera on the fleet centroid
+  RedrawScheduler redraw_;
   std::deque<Px4Client::LogEntry> log_data_;
 
   Px4Client &px4_client_;
   bool ctrl_in_world_ = false;
   bool keyboard_listener_active_ = false;
   int keyboard_target_id_ = -1;
+  int focused_id_ = -1;
+  bool window_visible_ = true;
+  float plot_span_sec_ = 10.0F; // visible time span of the line plots
+  std::vector<ChannelId> plot_channels_ = {ChannelId::POS_Z, ChannelId::THRUST_SP,
+                                           ChannelId::OMEGA_SP_X, ChannelId::OMEGA_SP_Y,
+                                           ChannelId::OMEGA_SP_Z};
+  // Channels any view has asked history to record; read by the observer.
+  std::atomic<uint64_t> wanted_channels_{0};
   bool show_disarm_confirm_ = false;
   int disarm_confirm_target_id_ = -1;
   float keyboard_vel_xy_ = 1.0F;
   float keyboard_vel_z_ = 0.2F;
   float keyboard_vel_yaw_ = 2.0F;
+  GamepadSample gamepad_;
+  std::array<uint8_t, 15> pad_buttons_{}; // previous frame, for button edges
+  bool gamepad_enabled_ = true;
+  float gamepad_deadzone_ = 0.08F;
+  float gamepad_expo_ = 0.4F;
+  bool pad_nav_suspended_ = false;
 
   static bool valid_limit(float limit);
-  static void trim_deque(std::deque<float> &q, size_t max_points);
-  static void trim_deque(std::deque<ImVec2> &q, size_t max_points);
-  static void render_line_plot(const char *label, const std::deque<float> &series,
-                               ImVec2 size, float sample_hz,
-                               float min_v = FLT_MAX, float max_v = FLT_MAX,
-                               ImU32 line_color = 0);
-  static void render_xy_plot(const char *label, const std::deque<ImVec2> &series,
-                             ImVec2 size, const float *geofence_min = nullptr,
+  void render_line_plot(const char *label, uint8_t id, const TelemetryRing &ring,
+                        ChannelId channel, double t_begin, double t_end,
+                        uint64_t version, PlotGeometryCache &cache, ImVec2 size,
+                        float min_v = FLT_MAX, float max_v = FLT_MAX,
+                        ImU32 line_color = 0);
+  static void render_envelope_plot(const char *label, const PyramidLevel &level,
+                                   ChannelId channel, double t_begin,
+                                   double t_end, uint64_t version,
+                                   PlotGeometryCache &cache, ImVec2 size,
+                                   float min_v = FLT_MAX, float max_v = FLT_MAX,
+                                   ImU32 line_color = 0);
+  static void render_xy_plot(const char *label, const TelemetryRing &ring, double t_begin,
+                             uint64_t version, PlotGeometryCache &cache, ImVec2 size,
+                             const float *geofence_min = nullptr,
                              const float *geofence_max = nullptr,
                              bool geofence_enabled = false);
   static ImU32 PhaseColor(int phase_idx);
@@ -122,16 +300,51 @@ private:
   void render_status_panel(uint8_t id, const ServerPayload &drone);
   void render_command_panel(uint8_t id, const ServerPayload &drone);
   void render_safety_popup(uint8_t id);
+  void render_trajectory_popup(uint8_t id, const ServerPayload &drone);
+  void upload_trajectory(uint8_t id, const std::vector<TrajectoryPoint> &points, bool start);
+  void service_trajectory_uploads();
+  void render_group_panel(const std::vector<std::pair<uint8_t, ServerPayload>> &drones);
+  void send_group_command(ClientCommand cmd,
+                          const std::vector<std::pair<uint8_t, ServerPayload>> &targets);
+  void service_group_commands();
   void render_plot_panel(uint8_t id, const ServerPayload &drone);
+  void render_scene_panel(const std::vector<std::pair<uint8_t, ServerPayload>> &drones);
+  void render_fleet_tiles(const std::vector<std::pair<uint8_t, ServerPayload>> &drones);
+  void render_fleet_tile(uint8_t id, const ServerPayload &drone, ImVec2 size);
+  void render_drone_section(uint8_t id, const ServerPayload &drone, float body_h);
   void render_header_bar(const ServerPayload &drone);
+  void render_dispatch_tooltip();
+  void request_interaction_frames();
   void handle_keyboard_control();
+  void control_tick(double dt); // control thread
   void publish_heartbeat();
   void send_hover_target(uint8_t id, const std::array<float, 4> &hover);
   void send_simple_command(uint8_t id, ClientCommand cmd);
+  TelemetryTier telemetry_tier(uint8_t id, size_t drone_count) const;
+  void update_telemetry_rates(const std::vector<std::pair<uint8_t, ServerPayload>> &drones);
 
   clock::time_point last_heartbeat_time_ = clock::now();
   double heartbeat_interval_ms_ = 200.0;
+  const int64_t history_epoch_ns_ = steady_ns(); // arrival time origin
+  double rate_min_interval_ms_ = 250.0;  // debounce tier flapping while scrolling
+  double rate_refresh_interval_ms_ = 2000.0; // re-send so restarted servers pick it up
   mutable std::mutex data_mutex_;
+  // Written by handle_keyboard_control(), read by control_tick().
+  SnapshotStore<ControlInput> control_input_;
+  int64_t published_change_ns_ = 0; // control thread
+  int64_t max_input_age_ns_ = 0;    // older ControlInput samples count as idle
+  LatencyMeter input_latency_;      // axes change sampled -> hover target published
+  // After everything their callbacks touch: destroying an observer waits
+  // for its callback in flight on the pool, so they go first.
+  Px4DataObserver log_observer_;
+  // Per drone id; added by server_observer_ under data_mutex_, which must
+  // therefore be destroyed first.
+  std::map<uint8_t, Px4DataObserver> history_observers_;
+  Px4DataObserver server_observer_;
+  Px4DataObserver trajectory_ack_observer_;
+  Px4DataObserver group_ack_observer_;
+  // Last member: its thread stops before anything it touches is destroyed.
+  std::unique_ptr<FixedRateLoop> control_loop_;
 };
 
 inline std::array<double, 4> from_yaw(double yaw) {
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace px4ctrl {
+namespace ui {
+
+inline int64_t steady_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Gamepad state in the GLFW standard layout (GLFW_GAMEPAD_AXIS_* and
+// GLFW_GAMEPAD_BUTTON_* index these arrays). Sampled by the platform layer,
+// which owns the GLFW calls.
+struct GamepadSample {
+  bool connected = false;
+  std::string name;
+  std::array<float, 6> axes{};    // sticks in [-1, 1] (+y down), triggers
+  std::array<uint8_t, 15> buttons{};
+};
+
+// Maps a raw stick axis to a command: zero inside `deadzone`, rescaled so
+// the output starts from 0 at its edge, then blended towards a cubic by
+// `expo` (0 = linear, 1 = pure cubic) for finer control near center.
+inline float shape_axis(float v, float deadzone, float expo) {
+  const float mag = std::abs(v);
+  if (mag <= deadzone || deadzone >= 1.0F) return 0.0F;
+  const float x = std::min(1.0F, (mag - deadzone) / (1.0F - deadzone));
+  return std::copysign((1.0F - expo) * x + expo * x * x * x, v);
+}
+
+// Operator input as sampled by the UI thread and consumed by the control
+// loop through a SnapshotStore, so neither side waits on the other.
+// Older samples are treated as idle by the control loop, so a stalled UI
+// thread cannot leave a drone flying on the last held keys.
+inline constexpr int kMaxInputAgePeriods = 4;
+
+struct ControlInput {
+  int target = -1; // drone id under manual control, -1 = none
+  bool world = false; // axes in the world frame instead of the body frame
+  // Stick-like commands in [-1, 1]: forward, left, up, yaw (counter-clockwise).
+  std::array<float, 4> axes{};
+  std::array<float, 3> vel{}; // full-deflection rates: xy m/s, z m/s, yaw rad/s
+  int64_t changed_ns = 0;     // steady_ns() of the sample where axes last changed
+  int64_t sampled_ns = 0;     // steady_ns() of the latest UI sample
+  uint64_t version = 0;       // bumped per UI sample
+
+  void sync_from(const ControlInput &src) { *this = src; }
+  [[nodiscard]] bool idle() const {
+    return std::all_of(axes.begin(), axes.end(), [](float a) { return a == 0.0F; });
+  }
+};
+
+// Windowed average/maximum of latency samples: add() from one thread,
+// stats() from any.
+class LatencyMeter {
+public:
+  struct Stats {
+    double avg_ms = 0.0;
+    double max_ms = 0.0;
+    uint64_t count = 0; // samples since start
+  };
+
+  void add(double ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    if (now - window_start_ >= std::chrono::seconds(1)) {
+      // Keep the last window's figures until a new one has samples.
+      if (window_count_ > 0) {
+        stats_.avg_ms = window_sum_ / static_cast<double>(window_count_);
+        stats_.max_ms = window_max_;
+      }
+      window_start_ = now;
+      window_sum_ = window_max_ = 0.0;
+      window_count_ = 0;
+    }
+    window_sum_ += ms;
+    window_max_ = std::max(window_max_, ms);
+    ++window_count_;
+    ++stats_.count;
+    if (stats_.count == 1) {
+      stats_.avg_ms = stats_.max_ms = ms;
+    }
+  }
+
+  [[nodiscard]] Stats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  Stats stats_;
+  std::chrono::steady_clock::time_point window_start_ = std::chrono::steady_clock::now();
+  double window_sum_ = 0.0;
+  double window_max_ = 0.0;
+  uint64_t window_count_ = 0;
+};
+
+// Calls `tick(dt)` on its own thread at a fixed rate, against absolute
+// deadlines so the period does not drift with tick duration. A tick that
+// runs past the next deadline counts as an overrun and the schedule restarts
+// from now instead of bursting to catch up.
+class FixedRateLoop {
+public:
+  using Tick = InplaceFunction<void(double dt)>;
+
+  struct Stats {
+    double rate_hz = 0.0;         // measured ticks per second
+    double jitter_avg_ms = 0.0;   // wake-up lateness against the deadline
+    double jitter_max_ms = 0.0;
+    double tick_max_ms = 0.0;     // longest tick body
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;
+  };
+
+  FixedRateLoop(double hz, Tick tick)
+      : period_(std::chrono::duration_cast<steady::duration>(
+            std::chrono::duration<double>(1.0 / std::max(hz, 1.0)))),
+        tick_(std::move(tick)), thread_([this]() { run(); }) {}
+
+  FixedRateLoop(const FixedRateLoop &) = delete;
+  FixedRateLoop &operator=(const FixedRateLoop &) = delete;
+
+  ~FixedRateLoop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  [[nodiscard]] double period_sec() const {
+    return std::chrono::duration<double>(period_).count();
+  }
+
+  // Figures over the last completed ~1 s window; totals since start.
+  [[nodiscard]] Stats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+private:
+  using steady = std::chrono::steady_clock;
+
+  const steady::duration period_;
+  Tick tick_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  Stats stats_;
+  std::thread thread_; // last: starts once everything above exists
+
+  void run() {
+    auto deadline = steady::now() + period_;
+    auto last = steady::now();
+    auto window_start = last;
+    uint64_t window_ticks = 0;
+    uint64_t overruns = 0;
+    uint64_t total = 0;
+    double jitter_sum = 0.0;
+    double jitter_max = 0.0;
+    double tick_max = 0.0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_until(lock, deadline, [this]() { return stop_; })) {
+      lock.unlock();
+      const auto woke = steady::now();
+      const double jitter = std::chrono::duration<double, std::milli>(woke - deadline).count();
+      // A stalled thread must not turn into one huge integration step.
+      const double dt = std::min(std::chrono::duration<double>(woke - last).count(),
+                                 2.0 * period_sec());
+      last = woke;
+      tick_(dt);
+      const auto done = steady::now();
+
+      ++window_ticks;
+      ++total;
+      jitter_sum += jitter;
+      jitter_max = std::max(jitter_max, jitter);
+      tick_max = std::max(tick_max,
+                          std::chrono::duration<double, std::milli>(done - woke).count());
+      deadline += period_;
+      if (done >= deadline) {
+        ++overruns;
+        deadline = done + period_;
+      }
+
+      lock.lock();
+      const double wall = std::chrono::duration<double>(done - window_start).count();
+      if (wall >= 1.0) {
+        stats_.rate_hz = static_cast<double>(window_ticks) / wall;
+        stats_.jitter_avg_ms = jitter_sum / static_cast<double>(window_ticks);
+        stats_.jitter_max_ms = jitter_max;
+        stats_.tick_max_ms = tick_max;
+        window_start = done;
+        window_ticks = 0;
+        jitter_sum = jitter_max = tick_max = 0.0;
+      }
+      stats_.ticks = total;
+      stats_.overruns = overruns;
+    }
+  }
+};
+
+} // namespace ui
+} // namespace px4ctrl
@@ -85,13 +85,14 @@ enum class ClientCommand : uint32_t {
   FORCE_DISARM,
   CHANGE_HOVER_POS,
   SET_SAFETY_LIMITS,
+  SET_TELEMETRY_RATE,
 };
 
 static constexpr const char *CommandStr[] = {
     "HEARTBEAT",      "ARM",           "ENTER_OFFBOARD",
     "EXIT_OFFBOARD",  "TAKEOFF",       "LAND",
     "FORCE_HOVER",    "ALLOW_CMD_CTRL", "FORCE_DISARM",
-    "CHANGE_HOVER_POS", "SET_SAFETY_LIMITS",
+    "CHANGE_HOVER_POS", "SET_SAFETY_LIMITS", "SET_TELEMETRY_RATE",
 };
 
 struct SafetyLimitsPayload {
@@ -105,6 +106,22 @@ struct SafetyLimitsPayload {
   uint8_t reserved[2];
 };
 
+enum class TelemetryTier : uint8_t {
+  FOCUSED,
+  VISIBLE,
+  BACKGROUND,
+};
+
+static constexpr const char *TelemetryTierName[] = {
+    "FOCUSED", "VISIBLE", "BACKGROUND",
+};
+
+struct TelemetryRatePayload {
+  float rate_hz;        // requested ServerPayload stream rate for this id
+  TelemetryTier tier;   // why the client asked for it (informational)
+  uint8_t reserved[3];
+};
+
 struct ClientPayload {
   uint8_t id;
   uint64_t timestamp;
@@ -118,6 +135,8 @@ static_assert(std::is_trivially_copyable_v<ClientPayload>,
               "ClientPayload must be trivially copyable for wire transport");
 static_assert(sizeof(SafetyLimitsPayload) <= sizeof(ClientPayload::data),
               "SafetyLimitsPayload exceeds client payload data area");
+static_assert(sizeof(TelemetryRatePayload) <= sizeof(ClientPayload::data),
+              "TelemetryRatePayload exceeds client payload data area");
 static_assert(sizeof(ClientCommand) == sizeof(uint32_t),
               "ClientCommand wire size must stay 4 bytes");
 static_assert(sizeof(ServerPayload) == 240,
@@ -150,14 +169,38 @@ struct TransportParas {
   std::string server_topic = "px4s";
   std::string client_topic = "px4c";
   std::string log_topic = "px4log";
+  std::string trajectory_topic = "px4traj";         // chunked trajectory uploads
+  std::string trajectory_ack_topic = "px4traj_ack"; // server acks for them
+  std::string group_topic = "px4group";             // fleet-wide commands
+  std::string group_ack_topic = "px4group_ack";     // per-drone acks for them
   uint32_t telemetry_hz = 200;
 
+  // per-drone rates requested with SET_TELEMETRY_RATE
+  float telemetry_focused_hz = 200.0F;   // focused drone (full plots)
+  float telemetry_visible_hz = 50.0F;    // on screen, capped by UI frame rate
+  float telemetry_background_hz = 5.0F;  // scrolled away or window minimized
+
+  // worker threads that run telemetry/log observers off the zenoh thread
+  uint32_t observer_threads = 2;
+
   std::string zenoh_mode = "peer";
   std::string zenoh_connect;
   std::string zenoh_listen;
   bool zenoh_multicast_scouting = true;
   uint32_t zenoh_scouting_timeout_ms = 1000;
 
+  // UI redraw: event driven, never above max_fps, at least min_fps (0 = off)
+  float ui_max_fps = 60.0F;
+  float ui_min_fps = 1.0F;
+
+  // rate of the thread integrating and publishing manual hover targets
+  float control_hz = 50.0F;
+
+  // gamepad flies the keyboard target: left stick XY, right stick Z/yaw
+  bool gamepad_enabled = true;
+  float gamepad_deadzone = 0.08F; // fraction of stick travel ignored at center
+  float gamepad_expo = 0.4F;      // 0 linear .. 1 cubic
+
   // keyboard control defaults (can be adjusted online in ImGui)
   float keyboard_vel_xy = 1.0F;  // m/s
   float keyboard_vel_z = 0.2F;   // m/s
@@ -187,7 +230,23 @@ struct TransportParas {
       paras.server_topic = config.value("server_topic", paras.server_topic);
       paras.client_topic = config.value("client_topic", paras.client_topic);
       paras.log_topic = config.value("log_topic", paras.log_topic);
+      paras.trajectory_topic = config.value("trajectory_topic", paras.trajectory_topic);
+      paras.trajectory_ack_topic =
+          config.value("trajectory_ack_topic", paras.trajectory_ack_topic);
+      paras.group_topic = config.value("group_topic", paras.group_topic);
+      paras.group_ack_topic = config.value("group_ack_topic", paras.group_ack_topic);
       paras.telemetry_hz = config.value("telemetry_hz", paras.telemetry_hz);
+      paras.telemetry_focused_hz = static_cast<float>(paras.telemetry_hz);
+      paras.observer_threads = config.value("observer_threads", paras.observer_threads);
+      paras.control_hz = config.value("control_hz", paras.control_hz);
+
+      if (config.contains("telemetry_rates")) {
+        const auto &r = config.at("telemetry_rates");
+        paras.telemetry_focused_hz = r.value("focused", paras.telemetry_focused_hz);
+        paras.telemetry_visible_hz = r.value("visible", paras.telemetry_visible_hz);
+        paras.telemetry_background_hz =
+            r.value("background", paras.telemetry_background_hz);
+      }
 
       if (config.contains("zenoh")) {
         const auto &z = config.at("zenoh");
@@ -200,6 +259,19 @@ struct TransportParas {
             z.value("scouting_timeout_ms", paras.zenoh_scouting_timeout_ms);
       }
 
+      if (config.contains("ui")) {
+        const auto &u = config.at("ui");
+        paras.ui_max_fps = u.value("max_fps", paras.ui_max_fps);
+        paras.ui_min_fps = u.value("min_fps", paras.ui_min_fps);
+      }
+
+      if (config.contains("gamepad")) {
+        const auto &g = config.at("gamepad");
+        paras.gamepad_enabled = g.value("enabled", paras.gamepad_enabled);
+        paras.gamepad_deadzone = g.value("deadzone", paras.gamepad_deadzone);
+        paras.gamepad_expo = g.value("expo", paras.gamepad_expo);
+      }
+
       if (config.contains("keyboard")) {
         const auto &k = config.at("keyboard");
         paras.keyboard_vel_xy = k.value("vel_xy", paras.keyboard_vel_xy);
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace px4ctrl {
+
+// Owned by whoever owns the observables dispatching onto it, and declared
+// before them: queues only borrow the pool, so it is never destroyed (and
+// joined) from one of its own workers.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t threads) {
+    threads = std::max<size_t>(1, threads);
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      m_workers.emplace_back([this]() { run(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Pending tasks are discarded; running ones finish first.
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+      m_tasks.clear();
+    }
+    m_cv.notify_all();
+    for (auto &worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  inline void submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stop) {
+        return;
+      }
+      m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+  }
+
+  [[nodiscard]] inline size_t size() const { return m_workers.size(); }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::thread> m_workers;
+  bool m_stop = false;
+
+  inline void run() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+        if (m_stop) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+enum class DispatchPolicy {
+  DROP_OLDEST, // full queue evicts its oldest sample
+  BLOCK,       // full queue blocks the posting thread
+  COALESCE,    // only the newest undelivered sample is kept
+};
+
+static constexpr const char *DispatchPolicyName[] = {
+    "DROP_OLDEST", "BLOCK", "COALESCE",
+};
+
+struct DispatchOptions {
+  std::string name;
+  DispatchPolicy policy = DispatchPolicy::DROP_OLDEST;
+  size_t capacity = 1024;
+};
+
+struct DispatchStats {
+  std::string name;
+  DispatchPolicy policy = DispatchPolicy::DROP_OLDEST;
+  size_t depth = 0;
+  size_t max_depth = 0;
+  uint64_t delivered = 0;
+  uint64_t dropped = 0;
+};
+
+// Per-observer FIFO drained on a ThreadPool. At most one drain task per queue
+// is in flight, so a single observer always sees samples in post order while
+// different observers run in parallel.
+template <typename T>
+class DispatchQueue : public std::enable_shared_from_this<DispatchQueue<T>> {
+public:
+  DispatchQueue(ThreadPool &pool, DispatchOptions options, Callback<T> callback)
+      : m_pool(&pool), m_options(std::move(options)),
+        m_callback(std::move(callback)) {
+    m_options.capacity = std::max<size_t>(1, m_options.capacity);
+  }
+
+  inline void enqueue(const T &data) {
+    bool schedule = false;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_closed) {
+        return;
+      }
+      switch (m_options.policy) {
+      case DispatchPolicy::COALESCE:
+        if (!m_queue.empty()) {
+          m_queue.back() = data;
+          ++m_dropped;
+        } else {
+          m_queue.push_back(data);
+        }
+        break;
+      case DispatchPolicy::BLOCK:
+        m_space.wait(lock, [this]() {
+          return m_closed || m_queue.size() < m_options.capacity;
+        });
+        if (m_closed) {
+          return;
+        }
+        m_queue.push_back(data);
+        break;
+      case DispatchPolicy::DROP_OLDEST:
+        if (m_queue.size() >= m_options.capacity) {
+          m_queue.pop_front();
+          ++m_dropped;
+        }
+        m_queue.push_back(data);
+        break;
+      }
+      m_max_depth = std::max(m_max_depth, m_queue.size());
+      if (!m_scheduled) {
+        m_scheduled = true;
+        schedule = true;
+      }
+    }
+    if (schedule) {
+      m_pool->submit([self = this->shared_from_this()]() { self->drain(); });
+    }
+  }
+
+  // Stops delivery and waits for an in-flight callback (unless called from it).
+  inline void close() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_queue.clear();
+    m_space.notify_all();
+    m_idle.wait(lock, [this]() {
+      return m_running == std::thread::id() ||
+             m_running == std::this_thread::get_id();
+    });
+  }
+
+  [[nodiscard]] inline DispatchStats stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {m_options.name, m_options.policy, m_queue.size(), m_max_depth,
+            m_delivered, m_dropped};
+  }
+
+private:
+  // Bounded batch per task keeps one busy observer from starving the others.
+  static constexpr size_t kDrainBatch = 64;
+
+  ThreadPool *m_pool; // not owned; outlives the queue's last drain task
+  DispatchOptions m_options;
+  Callback<T> m_callback;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_space;
+  std::condition_variable m_idle;
+  std::deque<T> m_queue;
+  std::thread::id m_running;
+  bool m_scheduled = false;
+  bool m_closed = false;
+  size_t m_max_depth = 0;
+  uint64_t m_delivered = 0;
+  uint64_t m_dropped = 0;
+
+  inline void drain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (size_t n = 0; n < kDrainBatch && !m_closed && !m_queue.empty(); ++n) {
+      T item = std::move(m_queue.front());
+      m_queue.pop_front();
+      m_running = std::this_thread::get_id();
+      lock.unlock();
+      m_space.notify_one();
+
+      m_callback(item);
+
+      lock.lock();
+      m_running = std::thread::id();
+      ++m_delivered;
+      m_idle.notify_all();
+    }
+    if (!m_closed && !m_queue.empty()) {
+      lock.unlock();
+      m_pool->submit([self = this->shared_from_this()]() { self->drain(); });
+      return;
+    }
+    m_scheduled = false;
+  }
+};
+
+// Observable whose observers may run on a ThreadPool instead of the posting
+// thread. Inline observers behave exactly like Observable<T>.
+template <typename T> class AsyncObservable {
+public:
+  explicit AsyncObservable(ThreadPool &pool) : m_pool(&pool) {}
+
+  inline T value() const { return m_inline.value(); }
+
+  inline void post(const T &data) { m_inline.post(data); }
+
+  inline std::shared_ptr<Observer> observe(Callback<T> callback) {
+    return m_inline.observe(std::move(callback));
+  }
+
+  inline std::shared_ptr<Observer> observe(Callback<T> callback,
+                                           DispatchOptions options) {
+    auto queue = std::make_shared<DispatchQueue<T>>(*m_pool, std::move(options),
+                                                    std::move(callback));
+    auto forward = m_inline.observe([queue](const T &data) { queue->enqueue(data); });
+    {
+      std::lock_guard<std::mutex> lock(m_queues_mutex);
+      m_queues.push_back(queue);
+    }
+    return std::make_shared<Observer>(
+        [this, queue, forward](const Observer *) mutable {
+          forward.reset();
+          queue->close();
+          std::lock_guard<std::mutex> lock(m_queues_mutex);
+          m_queues.erase(std::remove(m_queues.begin(), m_queues.end(), queue),
+                         m_queues.end());
+        });
+  }
+
+  [[nodiscard]] inline std::vector<DispatchStats> stats() const {
+    std::lock_guard<std::mutex> lock(m_queues_mutex);
+    std::vector<DispatchStats> out;
+    out.reserve(m_queues.size());
+    for (const auto &queue : m_queues) {
+      out.push_back(queue->stats());
+    }
+    return out;
+  }
+
+private:
+  ThreadPool *m_pool; // not owned
+  Observable<T> m_inline;
+  mutable std::mutex m_queues_mutex;
+  std::vector<std::shared_ptr<DispatchQueue<T>>> m_queues;
+};
+
+// AsyncObservable fanned out by a small integer key (e.g. ServerPayload::id).
+// Each key owns its own channel in a flat table, so post() is one lookup and
+// observers of one key never run for samples of another. A key's channel is
+// created by its first sample or subscription and keeps its latest value.
+template <typename T, auto KeyMember> class KeyedObservable {
+public:
+  using Key = std::remove_cvref_t<decltype(std::declval<const T &>().*KeyMember)>;
+  static_assert(std::is_unsigned_v<Key> && sizeof(Key) == 1,
+                "KeyedObservable needs an 8-bit unsigned key");
+
+  explicit KeyedObservable(ThreadPool &pool) : m_pool(&pool), m_all(pool) {}
+
+  ~KeyedObservable() {
+    for (auto &slot : m_channels) {
+      delete slot.load();
+    }
+  }
+
+  KeyedObservable(const KeyedObservable &) = delete;
+  KeyedObservable &operator=(const KeyedObservable &) = delete;
+
+  // Latest sample of any key.
+  inline T value() const { return m_all.value(); }
+  // Latest sample of one key, whether or not anyone observes it; nullopt
+  // until a sample with that key has been posted.
+  inline std::optional<T> value(Key key) const {
+    if (!m_posted[key].load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    return m_channels[key].load(std::memory_order_acquire)->value();
+  }
+
+  inline void post(const T &data) {
+    m_all.post(data);
+    const Key key = data.*KeyMember;
+    auto *channel = m_channels[key].load(std::memory_order_acquire);
+    if (channel == nullptr) {
+      channel = &this->channel(key); // first sample of this key
+    }
+    channel->post(data);
+    if (!m_posted[key].load(std::memory_order_relaxed)) {
+      m_posted[key].store(true, std::memory_order_release);
+    }
+  }
+
+  // Observers of every key.
+  inline std::shared_ptr<Observer> observe(Callback<T> callback) {
+    return m_all.observe(std::move(callback));
+  }
+  inline std::shared_ptr<Observer> observe(Callback<T> callback,
+                                           DispatchOptions options) {
+    return m_all.observe(std::move(callback), std::move(options));
+  }
+
+  // Observers of a single key.
+  inline std::shared_ptr<Observer> observe(Key key, Callback<T> callback) {
+    return channel(key).observe(std::move(callback));
+  }
+  inline std::shared_ptr<Observer> observe(Key key, Callback<T> callback,
+                                           DispatchOptions options) {
+    return channel(key).observe(std::move(callback), std::move(options));
+  }
+
+  [[nodiscard]] inline std::vector<DispatchStats> stats() const {
+    auto out = m_all.stats();
+    for (const auto &slot : m_channels) {
+      if (const auto *channel = slot.load(std::memory_order_acquire)) {
+        const auto stats = channel->stats();
+        out.insert(out.end(), stats.begin(), stats.end());
+      }
+    }
+    return out;
+  }
+
+private:
+  static constexpr size_t kKeys = size_t{1} << (8 * sizeof(Key));
+
+  ThreadPool *m_pool; // not owned
+  AsyncObservable<T> m_all;
+  // Channels live as long as this object, so post() can use them without
+  // holding a lock once they exist.
+  std::array<std::atomic<AsyncObservable<T> *>, kKeys> m_channels{};
+  std::array<std::atomic<bool>, kKeys> m_posted{};
+  std::mutex m_channels_mutex;
+
+  inline AsyncObservable<T> &channel(Key key) {
+    std::lock_guard<std::mutex> lock(m_channels_mutex);
+    auto *channel = m_channels[key].load(std::memory_order_acquire);
+    if (channel == nullptr) {
+      channel = new AsyncObservable<T>(*m_pool);
+      m_channels[key].store(channel, std::memory_order_release);
+    }
+    return *channel;
+  }
+};
+
+template <typename T> using Px4AsyncData = AsyncObservable<T>;
+template <typename T, auto KeyMember>
+using Px4KeyedData = KeyedObservable<T, KeyMember>;
+
+} // namespace px4ctrl
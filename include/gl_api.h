@@ -0,0 +1,220 @@
+#pragma once
+
+// Minimal OpenGL 3.3 access for the GPU renderers. Only include from the
+// translation units that issue GL calls.
+
+#define GL_SILENCE_DEPRECATION
+#include <GLFW/glfw3.h> // Will drag system OpenGL headers
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_RENDERBUFFER
+#define GL_RENDERBUFFER 0x8D41
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_DEPTH_ATTACHMENT
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+namespace px4ctrl {
+namespace ui {
+
+// GL 2.0+ entry points, resolved through GLFW so no loader library is needed:
+// (return type, name without the gl prefix, parameters). GL 1.1 functions are
+// called directly.
+#define PX4_GL_FUNCTIONS(X)                                                    \
+  X(GLuint, CreateShader, (GLenum type))                                       \
+  X(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar *const *str, const GLint *len)) \
+  X(void, CompileShader, (GLuint shader))                                      \
+  X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint *params))           \
+  X(void, GetShaderInfoLog, (GLuint shader, GLsizei size, GLsizei *len, GLchar *log)) \
+  X(void, DeleteShader, (GLuint shader))                                       \
+  X(GLuint, CreateProgram, (void))                                             \
+  X(void, AttachShader, (GLuint program, GLuint shader))                       \
+  X(void, LinkProgram, (GLuint program))                                       \
+  X(void, GetProgramiv, (GLuint program, GLenum pname, GLint *params))         \
+  X(void, GetProgramInfoLog, (GLuint program, GLsizei size, GLsizei *len, GLchar *log)) \
+  X(void, DeleteProgram, (GLuint program))                                     \
+  X(void, UseProgram, (GLuint program))                                        \
+  X(GLint, GetUniformLocation, (GLuint program, const GLchar *name))           \
+  X(void, Uniform1f, (GLint location, GLfloat v0))                             \
+  X(void, Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)) \
+  X(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)) \
+  X(void, GenBuffers, (GLsizei n, GLuint *buffers))                            \
+  X(void, DeleteBuffers, (GLsizei n, const GLuint *buffers))                   \
+  X(void, BindBuffer, (GLenum target, GLuint buffer))                          \
+  X(void, BufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage)) \
+  X(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data)) \
+  X(void, GenVertexArrays, (GLsizei n, GLuint *arrays))                        \
+  X(void, DeleteVertexArrays, (GLsizei n, const GLuint *arrays))               \
+  X(void, BindVertexArray, (GLuint array))                                     \
+  X(void, EnableVertexAttribArray, (GLuint index))                             \
+  X(void, DisableVertexAttribArray, (GLuint index))                            \
+  X(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)) \
+  X(void, VertexAttrib4f, (GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w)) \
+  X(void, VertexAttribDivisor, (GLuint index, GLuint divisor))                 \
+  X(void, DrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instances)) \
+  X(void, GenFramebuffers, (GLsizei n, GLuint *framebuffers))                  \
+  X(void, DeleteFramebuffers, (GLsizei n, const GLuint *framebuffers))         \
+  X(void, BindFramebuffer, (GLenum target, GLuint framebuffer))                \
+  X(void, FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)) \
+  X(GLenum, CheckFramebufferStatus, (GLenum target))                           \
+  X(void, GenRenderbuffers, (GLsizei n, GLuint *renderbuffers))                \
+  X(void, DeleteRenderbuffers, (GLsizei n, const GLuint *renderbuffers))       \
+  X(void, BindRenderbuffer, (GLenum target, GLuint renderbuffer))              \
+  X(void, RenderbufferStorage, (GLenum target, GLenum format, GLsizei width, GLsizei height)) \
+  X(void, FramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum rbtarget, GLuint renderbuffer))
+
+struct GlApi {
+#define PX4_GL_DECLARE(ret, name, args)                                        \
+  using name##Fn = ret(APIENTRY *) args;                                       \
+  name##Fn name = nullptr;
+  PX4_GL_FUNCTIONS(PX4_GL_DECLARE)
+#undef PX4_GL_DECLARE
+
+  // Needs a current context; resolved once, later calls return the result.
+  bool load() {
+    if (loaded_) return ok_;
+    if (glfwGetCurrentContext() == nullptr) return false;
+    ok_ = true;
+#define PX4_GL_LOAD(ret, name, args)                                           \
+  name = reinterpret_cast<name##Fn>(glfwGetProcAddress("gl" #name));           \
+  if (name == nullptr) {                                                       \
+    spdlog::warn("OpenGL: gl{} unavailable", #name);                           \
+    ok_ = false;                                                               \
+  }
+    PX4_GL_FUNCTIONS(PX4_GL_LOAD)
+#undef PX4_GL_LOAD
+    loaded_ = true;
+    return ok_;
+  }
+
+private:
+  bool loaded_ = false;
+  bool ok_ = false;
+};
+
+inline GlApi gl;
+
+// Compiles and links a vertex/fragment pair; 0 (with the log) on failure.
+inline GLuint gl_build_program(const char *owner, const char *vertex_src,
+                               const char *fragment_src) {
+  auto compile = [owner](GLenum type, const char *source) -> GLuint {
+    const GLuint shader = gl.CreateShader(type);
+    gl.ShaderSource(shader, 1, &source, nullptr);
+    gl.CompileShader(shader);
+    GLint status = 0;
+    gl.GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == 0) {
+      GLint length = 0;
+      gl.GetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+      std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+      gl.GetShaderInfoLog(shader, length, nullptr, log.data());
+      spdlog::error("{}: shader compile failed: {}", owner, log);
+      gl.DeleteShader(shader);
+      return 0;
+    }
+    return shader;
+  };
+
+  const GLuint vs = compile(GL_VERTEX_SHADER, vertex_src);
+  const GLuint fs = compile(GL_FRAGMENT_SHADER, fragment_src);
+  if (vs == 0 || fs == 0) {
+    if (vs != 0) gl.DeleteShader(vs);
+    if (fs != 0) gl.DeleteShader(fs);
+    return 0;
+  }
+  const GLuint program = gl.CreateProgram();
+  gl.AttachShader(program, vs);
+  gl.AttachShader(program, fs);
+  gl.LinkProgram(program);
+  gl.DeleteShader(vs);
+  gl.DeleteShader(fs);
+  GLint status = 0;
+  gl.GetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status == 0) {
+    GLint length = 0;
+    gl.GetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+    gl.GetProgramInfoLog(program, length, nullptr, log.data());
+    spdlog::error("{}: program link failed: {}", owner, log);
+    gl.DeleteProgram(program);
+    return 0;
+  }
+  return program;
+}
+
+// Writes the newest `fresh` of `pushed` ring samples (`floats` per vertex,
+// oldest first) into the bound GL_ARRAY_BUFFER, laid out like the ring:
+// sample k in slot k % capacity, plus slot `capacity` mirroring slot 0 so
+// the step across the wrap point is still two adjacent vertices. At most
+// three glBufferSubData calls.
+inline void gl_write_ring_slots(uint64_t pushed, size_t capacity, size_t fresh,
+                                const float *data, size_t floats) {
+  if (fresh == 0) return;
+  const auto stride = static_cast<GLintptr>(floats * sizeof(float));
+  auto write = [&](size_t slot, size_t from, size_t n) {
+    gl.BufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(slot) * stride,
+                     static_cast<GLsizeiptr>(n) * stride, data + from * floats);
+  };
+  const size_t start = static_cast<size_t>((pushed - fresh) % capacity);
+  const size_t head = std::min(fresh, capacity - start);
+  write(start, 0, head);
+  if (fresh > head) write(0, head, fresh - head);
+  if (start == 0) {
+    write(capacity, 0, 1);
+  } else if (fresh > head) {
+    write(capacity, head, 1);
+  }
+}
+
+} // namespace ui
+} // namespace px4ctrl
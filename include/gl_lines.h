@@ -0,0 +1,93 @@
+#pragma once
+
+#include "history.h"
+
+#include <imgui.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Draws TelemetryRing channels on the GPU. Each series keeps a vertex buffer
+// laid out slot-for-slot like its ring column, so a frame uploads only the
+// samples pushed since the last one; segments are expanded to thick,
+// anti-aliased quads by an instanced shader run from an ImGui draw callback.
+//
+// All calls must be made on the thread owning the GL context. The renderer
+// stays inactive (ready() == false) until init() succeeds, and callers fall
+// back to ImGui polylines.
+class GlLineRenderer {
+public:
+  struct Style {
+    ImVec2 rect_min; // plot area, screen coordinates
+    ImVec2 rect_max;
+    double t_begin = 0.0;
+    double t_span = 1.0;
+    float min_v = 0.0F;
+    float max_v = 1.0F;
+    ImU32 color = IM_COL32_WHITE;
+    float thickness = 1.5F;
+  };
+
+  GlLineRenderer() = default;
+  ~GlLineRenderer() = default; // GL objects are released by shutdown()
+  GlLineRenderer(const GlLineRenderer &) = delete;
+  GlLineRenderer &operator=(const GlLineRenderer &) = delete;
+
+  // Loads the GL entry points and builds the shader; needs a current GL 3.3
+  // context.
+  bool init();
+  // Frees every GL object; call before the context is destroyed.
+  void shutdown();
+  [[nodiscard]] bool ready() const { return program_ != 0; }
+
+  // Forgets the previous frame's draw commands. Call once per frame before
+  // any draw(), after the previous frame's draw data was rendered.
+  void new_frame() { items_.clear(); }
+
+  // Brings series `key` up to date with `ring` and queues a callback on
+  // `draw` that renders its samples from age index `first` to the newest.
+  void draw(ImDrawList *draw, uint32_t key, const TelemetryRing &ring,
+            ChannelId channel, size_t first, const Style &style);
+
+private:
+  struct Series {
+    unsigned int vbo = 0;
+    size_t capacity = 0;   // ring capacity; the buffer holds capacity + 1 slots
+    uint64_t uploaded = 0; // ring pushed() count already on the GPU
+    size_t size = 0;       // channel samples on the GPU
+    double base = 0.0;     // stamp subtracted before narrowing to float
+  };
+
+  struct Item {
+    GlLineRenderer *self = nullptr;
+    const Series *series = nullptr;
+    size_t first_slot = 0;
+    size_t segments = 0;
+    double base = 0.0;
+    Style style;
+  };
+
+  unsigned int program_ = 0;
+  unsigned int vao_ = 0;
+  int u_display_ = -1;
+  int u_rect_ = -1;
+  int u_range_ = -1;
+  int u_color_ = -1;
+  int u_width_ = -1;
+  std::map<uint32_t, Series> series_;
+  std::deque<Item> items_; // stable addresses for callback user data
+  std::vector<float> staging_;
+
+  void upload(Series &series, const TelemetryRing &ring, ChannelId channel);
+  void render(const Item &item, const ImDrawCmd &cmd) const;
+  static void draw_callback(const ImDrawList *list, const ImDrawCmd *cmd);
+};
+
+} // namespace ui
+} // namespace px4ctrl
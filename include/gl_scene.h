@@ -0,0 +1,100 @@
+#pragma once
+
+#include "history.h"
+
+#include <imgui.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Offscreen 3D view of the fleet: ground grid, trajectory trails, geofence
+// boxes, hover targets and body-axis triads, rendered into a texture that
+// ImGui draws as an image. Trails live in vertex buffers mirroring each
+// drone's trail ring slot-for-slot, so only new positions are uploaded, and
+// the texture is re-rendered only when the camera, size or any drone state
+// changed.
+//
+// All calls must be made on the thread owning the GL context.
+class GlSceneRenderer {
+public:
+  struct Camera {
+    float yaw = -2.3F;   // rad, eye azimuth about +z
+    float pitch = 0.6F;  // rad, eye elevation
+    float distance = 25.0F;
+    std::array<float, 3> target{};
+
+    bool operator==(const Camera &) const = default;
+  };
+
+  struct Drone {
+    uint8_t id = 0;
+    ImU32 color = IM_COL32_WHITE;
+    std::array<float, 3> pos{};
+    std::array<float, 4> quat{1.0F, 0.0F, 0.0F, 0.0F}; // w, x, y, z
+    std::optional<std::array<float, 3>> hover;
+    std::array<float, 3> fence_min{};
+    std::array<float, 3> fence_max{};
+    bool fence_enabled = false;
+    // POS_X/Y/Z history; only read during render().
+    const TelemetryRing *trail = nullptr;
+  };
+
+  GlSceneRenderer() = default;
+  ~GlSceneRenderer() = default; // GL objects are released by shutdown()
+  GlSceneRenderer(const GlSceneRenderer &) = delete;
+  GlSceneRenderer &operator=(const GlSceneRenderer &) = delete;
+
+  bool init();
+  void shutdown();
+  [[nodiscard]] bool ready() const { return program_ != 0; }
+
+  // Brings the view up to date at `size` (ImGui units) and returns the
+  // texture to draw; its rows are bottom-up (uv0 = (0, 1), uv1 = (1, 0)).
+  ImTextureID render(ImVec2 size, const Camera &camera, const std::vector<Drone> &drones);
+
+  // Position of a world point inside the last rendered view (ImGui units
+  // from its top-left corner), or nullopt behind the camera.
+  [[nodiscard]] std::optional<ImVec2> project(const std::array<float, 3> &p) const;
+
+private:
+  struct Trail {
+    unsigned int vbo = 0;
+    size_t capacity = 0;   // ring capacity; the buffer holds capacity + 1 slots
+    uint64_t uploaded = 0; // ring pushed() count already on the GPU
+    size_t size = 0;
+  };
+
+  unsigned int program_ = 0;
+  unsigned int vao_ = 0;
+  unsigned int scratch_vbo_ = 0; // grid, boxes, triads: rebuilt per render
+  unsigned int fbo_ = 0;
+  unsigned int color_tex_ = 0;
+  unsigned int depth_rb_ = 0;
+  int u_mvp_ = -1;
+  int fb_w_ = 0;
+  int fb_h_ = 0;
+
+  std::map<uint8_t, Trail> trails_;
+  std::vector<float> staging_;
+  std::vector<float> scratch_;
+
+  // Inputs of the last render, to skip re-rendering an unchanged view.
+  ImVec2 size_;
+  Camera camera_;
+  std::vector<Drone> drones_;
+  std::array<float, 16> mvp_{};
+
+  bool resize_target(int width, int height);
+  bool upload_trail(Trail &trail, const TelemetryRing &ring);
+  void build_scratch(const std::vector<Drone> &drones);
+};
+
+} // namespace ui
+} // namespace px4ctrl
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "datas.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <type_traits>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Fleet-wide commands. One message on TransportParas::group_topic carries a
+// ClientCommand for a set of drones: a GroupCommandHeader followed by `count`
+// GroupMember, so landing 50 drones is one publish instead of 50. For
+// CHANGE_HOVER_POS each member flies to anchor + its offset, taken either
+// from the member (Formation::OFFSETS) or from a template computed on the
+// server with formation_offset(). Every member answers with a GroupAck on
+// group_ack_topic; resends carry the same seq and only the members still
+// missing, so a drone must apply a given seq once.
+inline constexpr uint32_t kGroupCommandMagic = 0x47344350; // "PC4G" little-endian
+inline constexpr uint32_t kGroupAckMagic = 0x4B344350;     // "PC4K" little-endian
+inline constexpr size_t kGroupMaxMembers = 255;
+
+enum class Formation : uint8_t {
+  OFFSETS, // per-member offsets as sent
+  LINE,    // abreast, left to right
+  GRID,    // rows of ceil(sqrt(size)), front to back
+  CIRCLE,
+};
+
+static constexpr const char *FormationName[] = {
+    "OFFSETS", "LINE", "GRID", "CIRCLE",
+};
+
+struct GroupCommandHeader {
+  uint32_t magic;
+  uint32_t seq;            // fresh per command; resends reuse it
+  ClientCommand command;
+  uint8_t count;           // GroupMember entries in this message
+  Formation formation;
+  uint8_t formation_size;  // members of the whole formation, for templates
+  uint8_t reserved0;
+  float anchor[4];         // CHANGE_HOVER_POS: formation origin x, y, z, yaw (rad)
+  float spacing;           // m between neighbours, templates only
+  uint32_t reserved1;
+  uint64_t timestamp;      // ms, like ClientPayload::timestamp
+};
+
+struct GroupMember {
+  uint8_t id;
+  uint8_t index;           // slot in the formation template
+  uint8_t reserved[2];
+  float offset[4];         // x, y, z, yaw from the anchor; OFFSETS only
+};
+
+enum class GroupAckStatus : uint8_t {
+  ACCEPTED,
+  REJECTED, // command not allowed in the drone's current phase
+};
+
+static constexpr const char *GroupAckStatusName[] = {
+    "ACCEPTED", "REJECTED",
+};
+
+struct GroupAck {
+  uint32_t magic;
+  uint32_t seq;
+  uint8_t id;
+  GroupAckStatus status;
+  uint8_t reserved[6];
+  uint64_t timestamp; // ms
+};
+
+static_assert(std::is_trivially_copyable_v<GroupCommandHeader> &&
+                  std::is_trivially_copyable_v<GroupMember> &&
+                  std::is_trivially_copyable_v<GroupAck>,
+              "Group messages must be trivially copyable for wire transport");
+static_assert(sizeof(GroupCommandHeader) == 48, "GroupCommandHeader wire size changed");
+static_assert(sizeof(GroupMember) == 20, "GroupMember wire size changed");
+static_assert(sizeof(GroupAck) == 24, "GroupAck wire size changed");
+
+// Offset (x, y, z, yaw) of template slot `index` out of `size`, before the
+// anchor yaw rotation applied by formation_target(). Zero for OFFSETS.
+inline std::array<float, 4> formation_offset(Formation formation, size_t index, size_t size,
+                                             float spacing) {
+  std::array<float, 4> offset{};
+  const float n = static_cast<float>(std::max<size_t>(size, 1));
+  const float i = static_cast<float>(index);
+  switch (formation) {
+  case Formation::OFFSETS:
+    break;
+  case Formation::LINE:
+    offset[1] = (0.5F * (n - 1.0F) - i) * spacing;
+    break;
+  case Formation::GRID: {
+    const size_t cols = static_cast<size_t>(std::ceil(std::sqrt(n)));
+    const size_t rows = (std::max<size_t>(size, 1) + cols - 1) / cols;
+    const float row = static_cast<float>(index / cols);
+    const float col = static_cast<float>(index % cols);
+    offset[0] = (0.5F * static_cast<float>(rows - 1) - row) * spacing;
+    offset[1] = (0.5F * static_cast<float>(cols - 1) - col) * spacing;
+    break;
+  }
+  case Formation::CIRCLE: {
+    // Neighbours `spacing` apart along the circle, never tighter than that
+    // radius.
+    const float radius = std::max(spacing, spacing * n / (2.0F * std::numbers::pi_v<float>));
+    const float angle = 2.0F * std::numbers::pi_v<float> * i / n;
+    offset[0] = radius * std::cos(angle);
+    offset[1] = radius * std::sin(angle);
+    break;
+  }
+  }
+  return offset;
+}
+
+// World hover target of `member`: anchor + offset, the offset rotated by the
+// anchor yaw so the formation turns with it.
+inline std::array<float, 4> formation_target(const GroupCommandHeader &header,
+                                             const GroupMember &member) {
+  const auto offset =
+      header.formation == Formation::OFFSETS
+          ? std::array<float, 4>{member.offset[0], member.offset[1], member.offset[2],
+                                 member.offset[3]}
+          : formation_offset(header.formation, member.index, header.formation_size,
+                             header.spacing);
+  const float c = std::cos(header.anchor[3]);
+  const float s = std::sin(header.anchor[3]);
+  return {header.anchor[0] + c * offset[0] - s * offset[1],
+          header.anchor[1] + s * offset[0] + c * offset[1], header.anchor[2] + offset[2],
+          header.anchor[3] + offset[3]};
+}
+
+// One ready-to-publish message; `header.count` is set from `members`.
+inline std::vector<uint8_t> encode_group_command(GroupCommandHeader header,
+                                                 const std::vector<GroupMember> &members) {
+  header.magic = kGroupCommandMagic;
+  header.count = static_cast<uint8_t>(std::min(members.size(), kGroupMaxMembers));
+  std::vector<uint8_t> message(sizeof(header) + header.count * sizeof(GroupMember));
+  std::memcpy(message.data(), &header, sizeof(header));
+  if (header.count > 0) {
+    std::memcpy(message.data() + sizeof(header), members.data(),
+                header.count * sizeof(GroupMember));
+  }
+  return message;
+}
+
+inline bool decode_group_ack(const uint8_t *data, size_t size, GroupAck &out) {
+  if (size != sizeof(GroupAck)) return false;
+  std::memcpy(&out, data, sizeof(out));
+  return out.magic == kGroupAckMagic &&
+         static_cast<size_t>(out.status) < std::size(GroupAckStatusName);
+}
+
+} // namespace ui
+} // namespace px4ctrl
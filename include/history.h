@@ -0,0 +1,505 @@
+#pragma once
+
+#include "channels.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Read-only view of a ring buffer column in age order: `first` holds the
+// oldest samples up to the end of storage, `second` the wrapped remainder.
+template <typename T> struct RingView {
+  std::span<const T> first;
+  std::span<const T> second;
+
+  [[nodiscard]] size_t size() const { return first.size() + second.size(); }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  const T &operator[](size_t i) const {
+    return i < first.size() ? first[i] : second[i - first.size()];
+  }
+  const T &front() const { return (*this)[0]; }
+  const T &back() const { return (*this)[size() - 1]; }
+
+  // Elements [pos, pos + count) in age order, still as two spans.
+  [[nodiscard]] RingView subview(size_t pos, size_t count) const {
+    pos = std::min(pos, size());
+    count = std::min(count, size() - pos);
+    if (pos >= first.size()) {
+      return {second.subspan(pos - first.size(), count), {}};
+    }
+    const size_t head = std::min(count, first.size() - pos);
+    return {first.subspan(pos, head), second.subspan(0, count - head)};
+  }
+
+  template <typename F> void for_each(F &&f) const {
+    for (const auto &v : first) f(v);
+    for (const auto &v : second) f(v);
+  }
+};
+
+template <typename T>
+RingView<T> make_ring_view(const T *base, size_t capacity, size_t head, size_t size) {
+  const size_t oldest = (head + capacity - size) % std::max<size_t>(1, capacity);
+  const size_t first = std::min(size, capacity - oldest);
+  return {std::span<const T>(base + oldest, first),
+          std::span<const T>(base, size - first)};
+}
+
+// Monotonic queue over the last `window` samples: Keep(a, b) is true when an
+// older a must stay queued ahead of a newer b. With std::less the front is
+// the window minimum, with std::greater the maximum. Each sample is queued
+// and dequeued at most once, so push is amortized O(1).
+template <typename Keep> class MonotonicQueue {
+public:
+  void push(uint64_t n, float v, size_t window) {
+    if (slots_.size() != window) {
+      slots_.assign(window, {});
+      head_ = tail_ = 0;
+    }
+    while (head_ != tail_ && slots_[head_ % window].n + window <= n) ++head_;
+    while (head_ != tail_ && !Keep{}(slots_[(tail_ - 1) % window].v, v)) --tail_;
+    slots_[tail_++ % window] = {n, v};
+  }
+
+  [[nodiscard]] float front() const { return slots_[head_ % slots_.size()].v; }
+
+private:
+  struct Slot {
+    uint64_t n = 0;
+    float v = 0.0F;
+  };
+  std::vector<Slot> slots_; // allocated on first push
+  uint64_t head_ = 0;
+  uint64_t tail_ = 0;
+};
+
+// Maps server sample timestamps onto the client's time axis. The offset is
+// anchored on the least-delayed sample seen, so network jitter does not
+// move points; the result never decreases, keeping time columns sorted for
+// binary search even across server clock steps.
+class SampleClock {
+public:
+  // A sample arriving this much later than the best offset predicts is
+  // taken as a server clock step (e.g. restart) and re-anchors the offset.
+  static constexpr double kResyncSec = 1.0;
+
+  double align(double server_sec, double arrival_sec) {
+    double t = arrival_sec;
+    if (server_sec > 0.0) {
+      const double offset = arrival_sec - server_sec;
+      if (!anchored_ || offset < offset_ || offset - offset_ > kResyncSec) {
+        offset_ = offset;
+        anchored_ = true;
+      }
+      t = server_sec + offset_;
+    }
+    last_ = std::max(last_, t);
+    return last_;
+  }
+
+private:
+  bool anchored_ = false;
+  double offset_ = 0.0;
+  double last_ = -std::numeric_limits<double>::infinity();
+};
+
+// Struct-of-arrays ring of raw telemetry samples. All channels share one
+// head index, a sample time column (server clock aligned to the client,
+// non-decreasing) and an arrival time column. Channel columns are allocated
+// only once enable()d and hold the samples pushed since then.
+class TelemetryRing {
+public:
+  using Channel = ChannelId;
+  using Sample = std::array<float, kChannelCount>;
+
+  explicit TelemetryRing(size_t capacity = 1200)
+      : capacity_(std::max<size_t>(1, capacity)), t_(capacity_), arrival_(capacity_) {}
+
+  // Starts recording a channel from the next push on.
+  void enable(Channel c) {
+    auto &col = columns_[index(c)];
+    if (col.data.empty()) {
+      col.data.assign(capacity_, 0.0F);
+      col.since = pushed_;
+    }
+  }
+  [[nodiscard]] bool enabled(Channel c) const { return !columns_[index(c)].data.empty(); }
+
+  void push(double t, double arrival, const Sample &sample) {
+    const size_t head = pushed_ % capacity_;
+    t_[head] = t;
+    arrival_[head] = arrival;
+    for (size_t c = 0; c < kChannelCount; ++c) {
+      auto &col = columns_[c];
+      if (col.data.empty()) continue;
+      col.data[head] = sample[c];
+      col.min_queue.push(pushed_, sample[c], capacity_);
+      col.max_queue.push(pushed_, sample[c], capacity_);
+      col.min = col.min_queue.front();
+      col.max = col.max_queue.front();
+    }
+    ++pushed_;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return static_cast<size_t>(std::min<uint64_t>(pushed_, capacity_));
+  }
+  [[nodiscard]] bool empty() const { return pushed_ == 0; }
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+  // Samples pushed over the ring's lifetime; sample k sits in slot
+  // k % capacity(), so mirrors can fetch only what is new.
+  [[nodiscard]] uint64_t pushed() const { return pushed_; }
+
+  [[nodiscard]] RingView<double> stamps() const { return view(t_.data(), size()); }
+  [[nodiscard]] RingView<double> arrivals() const { return view(arrival_.data(), size()); }
+
+  // Samples recorded for one channel, and the matching tail of stamps() /
+  // arrivals(); all three are index-aligned.
+  [[nodiscard]] size_t size(Channel c) const {
+    const auto &col = columns_[index(c)];
+    return col.data.empty() ? 0 : static_cast<size_t>(std::min<uint64_t>(pushed_ - col.since, size()));
+  }
+  [[nodiscard]] RingView<float> channel(Channel c) const {
+    return view(columns_[index(c)].data.data(), size(c));
+  }
+  [[nodiscard]] RingView<double> stamps(Channel c) const { return view(t_.data(), size(c)); }
+  [[nodiscard]] RingView<double> arrivals(Channel c) const {
+    return view(arrival_.data(), size(c));
+  }
+
+  // Extrema of a channel over the samples currently held; O(1).
+  [[nodiscard]] float min(Channel c) const { return columns_[index(c)].min; }
+  [[nodiscard]] float max(Channel c) const { return columns_[index(c)].max; }
+
+  // Copies only the samples pushed since this ring was last synced. The
+  // monotonic queues stay with the writer; copies carry just the extrema.
+  void sync_from(const TelemetryRing &src) {
+    const bool full = capacity_ != src.capacity_ || src.pushed_ < pushed_ ||
+                      src.pushed_ - pushed_ > capacity_;
+    if (full) {
+      capacity_ = src.capacity_;
+      t_ = src.t_;
+      arrival_ = src.arrival_;
+    } else {
+      copy_slots(t_, src.t_, pushed_, src.pushed_);
+      copy_slots(arrival_, src.arrival_, pushed_, src.pushed_);
+    }
+    for (size_t c = 0; c < kChannelCount; ++c) {
+      auto &col = columns_[c];
+      const auto &src_col = src.columns_[c];
+      if (src_col.data.empty()) {
+        col.data.clear();
+        continue;
+      }
+      if (full || col.data.size() != src_col.data.size() || col.since != src_col.since) {
+        col.data = src_col.data;
+        col.since = src_col.since;
+      } else {
+        copy_slots(col.data, src_col.data, pushed_, src.pushed_);
+      }
+      col.min = src_col.min;
+      col.max = src_col.max;
+    }
+    pushed_ = src.pushed_;
+  }
+
+private:
+  struct Column {
+    std::vector<float> data; // empty until enabled
+    uint64_t since = 0;      // number of the first sample recorded
+    float min = 0.0F;
+    float max = 0.0F;
+    MonotonicQueue<std::less<float>> min_queue;
+    MonotonicQueue<std::greater<float>> max_queue;
+  };
+
+  size_t capacity_;
+  uint64_t pushed_ = 0; // total samples; next slot is pushed_ % capacity_
+  std::vector<double> t_;
+  std::vector<double> arrival_;
+  std::array<Column, kChannelCount> columns_;
+
+  static size_t index(Channel c) { return static_cast<size_t>(c); }
+
+  // The newest `count` entries of a column.
+  template <typename T> RingView<T> view(const T *base, size_t count) const {
+    const auto all = make_ring_view(base, capacity_, pushed_ % capacity_, size());
+    return all.subview(all.size() - count, count);
+  }
+
+  template <typename T>
+  void copy_slots(std::vector<T> &dst, const std::vector<T> &src, uint64_t from,
+                  uint64_t to) const {
+    for (uint64_t n = from; n < to; ++n) {
+      dst[n % capacity_] = src[n % capacity_];
+    }
+  }
+};
+
+// Min and max of a non-empty view, O(n). TelemetryRing::min()/max() are O(1)
+// but cover the whole ring, not a visible window of it.
+inline void view_extrema(const RingView<float> &values, float &lo, float &hi) {
+  lo = values.front();
+  hi = values.front();
+  values.for_each([&](const float v) {
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  });
+}
+
+// M4 decimation: splits [t_begin, t_end] into `columns` equal time columns
+// and emits, in time order, the index of the first, min, max and last
+// sample of each. A line through the emitted samples covers the same pixels
+// as one through every sample when a column is one pixel wide, so output
+// size is bounded by 4 * columns regardless of history length.
+template <typename Emit>
+void m4_decimate(const RingView<double> &stamps, const RingView<float> &values,
+                 double t_begin, double t_end, size_t columns, Emit &&emit) {
+  const size_t n = values.size();
+  if (n <= columns * 4) {
+    for (size_t i = 0; i < n; ++i) emit(i);
+    return;
+  }
+  const double scale = static_cast<double>(columns) / std::max(1e-9, t_end - t_begin);
+  auto column_of = [&](size_t i) {
+    const double c = std::floor((stamps[i] - t_begin) * scale);
+    return static_cast<size_t>(std::clamp(c, 0.0, static_cast<double>(columns - 1)));
+  };
+
+  for (size_t i = 0; i < n;) {
+    const size_t col = column_of(i);
+    const size_t first = i;
+    size_t lo = i;
+    size_t hi = i;
+    for (++i; i < n && column_of(i) == col; ++i) {
+      if (values[i] < values[lo]) lo = i;
+      if (values[i] > values[hi]) hi = i;
+    }
+    const size_t last = i - 1;
+    const size_t mid_a = std::min(lo, hi);
+    const size_t mid_b = std::max(lo, hi);
+    emit(first);
+    if (mid_a != first) emit(mid_a);
+    if (mid_b != mid_a && mid_b != first) emit(mid_b);
+    if (last != mid_b && last != first) emit(last);
+  }
+}
+
+// Returns the first index in [0, view.size()) whose key is not less than
+// `key`. Keys must be non-decreasing in age order (e.g. a time column).
+template <typename T, typename Key, typename Proj>
+size_t ring_lower_bound(const RingView<T> &view, const Key &key, Proj &&proj) {
+  size_t lo = 0;
+  size_t hi = view.size();
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (proj(view[mid]) < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// One level of the telemetry pyramid: a struct-of-arrays ring of buckets,
+// each aggregating `factor` consecutive raw samples into min/max/mean per
+// enabled channel. The newest bucket is updated in place until it is full,
+// so the level is current to the last sample and ingest cost is
+// O(enabled channels).
+class PyramidLevel {
+public:
+  using Channel = ChannelId;
+
+  PyramidLevel(size_t factor = 10, size_t capacity = 1200)
+      : factor_(std::max<size_t>(1, factor)), capacity_(std::max<size_t>(1, capacity)),
+        t0_(capacity_), t1_(capacity_) {}
+
+  // Starts aggregating a channel from the next bucket on.
+  void enable(Channel c) {
+    auto &col = columns_[index(c)];
+    if (col.min.empty()) {
+      col.min.assign(capacity_, 0.0F);
+      col.max.assign(capacity_, 0.0F);
+      col.mean.assign(capacity_, 0.0F);
+      col.since = pushed_; // the bucket filling now, if any, is skipped
+    }
+  }
+
+  void push(double t, const TelemetryRing::Sample &sample) {
+    if (fill_ == 0) {
+      const size_t slot = pushed_ % capacity_;
+      t0_[slot] = t;
+      for (size_t c = 0; c < kChannelCount; ++c) {
+        auto &col = columns_[c];
+        if (col.min.empty() || col.since > pushed_) continue;
+        col.min[slot] = sample[c];
+        col.max[slot] = sample[c];
+        col.mean[slot] = sample[c];
+      }
+      ++pushed_;
+    } else {
+      const size_t slot = (pushed_ - 1) % capacity_;
+      const float n = static_cast<float>(fill_ + 1);
+      for (size_t c = 0; c < kChannelCount; ++c) {
+        auto &col = columns_[c];
+        if (col.min.empty() || col.since >= pushed_) continue;
+        col.min[slot] = std::min(col.min[slot], sample[c]);
+        col.max[slot] = std::max(col.max[slot], sample[c]);
+        col.mean[slot] += (sample[c] - col.mean[slot]) / n;
+      }
+    }
+    t1_[(pushed_ - 1) % capacity_] = t;
+    fill_ = (fill_ + 1) % factor_;
+  }
+
+  [[nodiscard]] size_t factor() const { return factor_; }
+  [[nodiscard]] size_t size() const {
+    return static_cast<size_t>(std::min<uint64_t>(pushed_, capacity_));
+  }
+  [[nodiscard]] bool empty() const { return pushed_ == 0; }
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+
+  // Buckets aggregated for one channel; all views below are index-aligned.
+  [[nodiscard]] size_t size(Channel c) const {
+    const auto &col = columns_[index(c)];
+    if (col.min.empty() || col.since >= pushed_) return 0;
+    return static_cast<size_t>(std::min<uint64_t>(pushed_ - col.since, size()));
+  }
+  // Bucket first/last sample times.
+  [[nodiscard]] RingView<double> starts(Channel c) const { return view(t0_.data(), size(c)); }
+  [[nodiscard]] RingView<double> ends(Channel c) const { return view(t1_.data(), size(c)); }
+  [[nodiscard]] RingView<float> min(Channel c) const {
+    return view(columns_[index(c)].min.data(), size(c));
+  }
+  [[nodiscard]] RingView<float> max(Channel c) const {
+    return view(columns_[index(c)].max.data(), size(c));
+  }
+  [[nodiscard]] RingView<float> mean(Channel c) const {
+    return view(columns_[index(c)].mean.data(), size(c));
+  }
+
+  // Time covered by the buckets currently held.
+  [[nodiscard]] double span_sec() const {
+    if (empty()) return 0.0;
+    const auto t0 = view(t0_.data(), size());
+    const auto t1 = view(t1_.data(), size());
+    return t1.back() - t0.front();
+  }
+
+  // Copies the buckets opened since the last sync plus the (possibly still
+  // filling) newest one.
+  void sync_from(const PyramidLevel &src) {
+    const uint64_t from = pushed_ > 0 ? pushed_ - 1 : 0;
+    const bool full = capacity_ != src.capacity_ || src.pushed_ < pushed_ ||
+                      src.pushed_ - from > capacity_;
+    if (full) {
+      capacity_ = src.capacity_;
+      t0_ = src.t0_;
+      t1_ = src.t1_;
+    } else {
+      copy_slots(t0_, src.t0_, from, src.pushed_);
+      copy_slots(t1_, src.t1_, from, src.pushed_);
+    }
+    for (size_t c = 0; c < kChannelCount; ++c) {
+      auto &col = columns_[c];
+      const auto &src_col = src.columns_[c];
+      if (src_col.min.empty()) {
+        col = Column{};
+        continue;
+      }
+      if (full || col.min.size() != src_col.min.size() || col.since != src_col.since) {
+        col = src_col;
+      } else {
+        copy_slots(col.min, src_col.min, from, src.pushed_);
+        copy_slots(col.max, src_col.max, from, src.pushed_);
+        copy_slots(col.mean, src_col.mean, from, src.pushed_);
+      }
+    }
+    factor_ = src.factor_;
+    pushed_ = src.pushed_;
+    fill_ = src.fill_;
+  }
+
+private:
+  struct Column {
+    std::vector<float> min; // all three empty until enabled
+    std::vector<float> max;
+    std::vector<float> mean;
+    uint64_t since = 0; // number of the first bucket aggregated
+  };
+
+  size_t factor_;
+  size_t capacity_;
+  uint64_t pushed_ = 0; // buckets opened; newest is (pushed_ - 1) % capacity_
+  size_t fill_ = 0;     // samples in the newest bucket, 0 once it is full
+  std::vector<double> t0_;
+  std::vector<double> t1_;
+  std::array<Column, kChannelCount> columns_;
+
+  static size_t index(Channel c) { return static_cast<size_t>(c); }
+
+  // The newest `count` buckets of a column.
+  template <typename T> RingView<T> view(const T *base, size_t count) const {
+    const auto all = make_ring_view(base, capacity_, pushed_ % capacity_, size());
+    return all.subview(all.size() - count, count);
+  }
+
+  template <typename T>
+  void copy_slots(std::vector<T> &dst, const std::vector<T> &src, uint64_t from,
+                  uint64_t to) const {
+    for (uint64_t n = from; n < to; ++n) {
+      dst[n % capacity_] = src[n % capacity_];
+    }
+  }
+};
+
+// Single-writer, single-reader history with versioned read snapshots.
+// The writer mutates live() and calls publish(), which syncs the spare
+// buffer from live (incrementally, via H::sync_from) and hands it over
+// through a lock-free triple buffer. snapshot() returns an immutable copy
+// that the writer never touches until the reader moves on, so readers
+// hold no lock and copy nothing; H::version tells them whether anything
+// changed since the last frame.
+template <typename H> class SnapshotStore {
+public:
+  H &live() { return live_; }
+
+  void publish() {
+    auto &back = buffers_[back_];
+    back.sync_from(live_);
+    const uint8_t prev = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = prev & kIndexMask;
+  }
+
+  const H &snapshot() {
+    if (middle_.load(std::memory_order_relaxed) & kFresh) {
+      const uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+      front_ = prev & kIndexMask;
+    }
+    return buffers_[front_];
+  }
+
+private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFresh = 0x4;
+
+  H live_;
+  std::array<H, 3> buffers_;
+  uint8_t back_ = 0;  // writer only
+  uint8_t front_ = 1; // reader only
+  std::atomic<uint8_t> middle_{2};
+};
+
+} // namespace ui
+} // namespace px4ctrl
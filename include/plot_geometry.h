@@ -0,0 +1,102 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Vertices and indices one plot appended to its draw list. While the data
+// version, plot size and drawing parameters are unchanged the plot replays
+// them, translated to its current origin, instead of re-tessellating grid,
+// tick labels and polyline.
+class PlotGeometryCache {
+public:
+  using Params = std::array<float, 8>;
+
+  static float color_param(ImU32 color) { return std::bit_cast<float>(color); }
+
+  // Appends the cached geometry at `origin`. Returns false if nothing valid
+  // was recorded for this key and the caller must draw (and record).
+  bool replay(ImDrawList *draw, uint64_t version, ImVec2 origin, ImVec2 size,
+              const Params &params) const {
+    if (!valid_ || version != version_ || size.x != size_.x || size.y != size_.y ||
+        params != params_) {
+      return false;
+    }
+    draw->PrimReserve(static_cast<int>(idx_.size()), static_cast<int>(vtx_.size()));
+    const auto base = static_cast<ImDrawIdx>(draw->_VtxCurrentIdx);
+    const float dx = origin.x - origin_.x;
+    const float dy = origin.y - origin_.y;
+    for (const auto &v : vtx_) {
+      *draw->_VtxWritePtr++ = {ImVec2(v.pos.x + dx, v.pos.y + dy), v.uv, v.col};
+    }
+    for (const auto i : idx_) {
+      *draw->_IdxWritePtr++ = static_cast<ImDrawIdx>(base + i);
+    }
+    draw->_VtxCurrentIdx += static_cast<unsigned int>(vtx_.size());
+    return true;
+  }
+
+  // Brackets the draw calls to record.
+  void begin(ImDrawList *draw, uint64_t version, ImVec2 origin, ImVec2 size,
+             const Params &params) {
+    valid_ = false;
+    version_ = version;
+    origin_ = origin;
+    size_ = size;
+    params_ = params;
+    cmd_count_ = draw->CmdBuffer.Size;
+    vtx_begin_ = draw->VtxBuffer.Size;
+    idx_begin_ = draw->IdxBuffer.Size;
+    base_ = draw->_VtxCurrentIdx;
+
+    // Text outside the clip rect is culled at tessellation time, so a plot
+    // recorded while partly scrolled out would replay with missing labels.
+    const ImVec2 clip_min = draw->GetClipRectMin();
+    const ImVec2 clip_max = draw->GetClipRectMax();
+    recordable_ = origin.x >= clip_min.x && origin.y >= clip_min.y &&
+                  origin.x + size.x <= clip_max.x && origin.y + size.y <= clip_max.y;
+  }
+
+  void end(ImDrawList *draw) {
+    // A new draw command (clip/texture change or 16-bit index rollover)
+    // would make the recorded indices meaningless on replay.
+    if (!recordable_ || draw->CmdBuffer.Size != cmd_count_ ||
+        draw->_VtxCurrentIdx < base_) {
+      return;
+    }
+    vtx_.assign(draw->VtxBuffer.Data + vtx_begin_,
+                draw->VtxBuffer.Data + draw->VtxBuffer.Size);
+    idx_.resize(static_cast<size_t>(draw->IdxBuffer.Size - idx_begin_));
+    for (size_t i = 0; i < idx_.size(); ++i) {
+      idx_[i] = static_cast<ImDrawIdx>(draw->IdxBuffer[idx_begin_ + static_cast<int>(i)] - base_);
+    }
+    valid_ = true;
+  }
+
+  // Polyline scratch kept here so its capacity survives across frames.
+  std::vector<ImVec2> points;
+
+private:
+  bool valid_ = false;
+  bool recordable_ = false;
+  uint64_t version_ = 0;
+  ImVec2 origin_;
+  ImVec2 size_;
+  Params params_{};
+  int cmd_count_ = 0;
+  int vtx_begin_ = 0;
+  int idx_begin_ = 0;
+  unsigned int base_ = 0;
+  std::vector<ImDrawVert> vtx_;
+  std::vector<ImDrawIdx> idx_;
+};
+
+} // namespace ui
+} // namespace px4ctrl
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+namespace px4ctrl {
+namespace ui {
+
+// Decides when the UI loop renders instead of spinning at full speed. A frame
+// is due when input arrives, when another thread calls notify() (new data),
+// when the render thread asked for one by a deadline (animation, held keys,
+// heartbeats), or when 1/min_fps has passed since the last one; frames are
+// never closer than 1/max_fps. Waiting is delegated to the platform (e.g.
+// glfwWaitEventsTimeout) and `wake` unblocks it from other threads (e.g.
+// glfwPostEmptyEvent).
+//
+// wait(), frame_presented() and request_by() belong to the render thread;
+// notify() and stats() may be called from any thread.
+class RedrawScheduler {
+public:
+  using steady = std::chrono::steady_clock;
+
+  struct Stats {
+    double fps = 0.0;
+    double idle = 0.0;           // fraction of wall time the render thread waited
+    double cpu = 0.0;            // process CPU time / wall time (1.0 = one core)
+    double latency_avg_ms = 0.0; // data arrival (or notify()) to buffer swap
+    double latency_max_ms = 0.0;
+    uint64_t frames = 0;
+  };
+
+  // max_fps <= 0: uncapped; min_fps <= 0: no periodic redraw.
+  void set_limits(float max_fps, float min_fps) {
+    max_fps_ = max_fps;
+    min_interval_ = interval(max_fps, 0.0);
+    max_interval_ = interval(min_fps, 3600.0);
+  }
+  [[nodiscard]] float max_fps() const { return max_fps_; }
+
+  // Unblocks the render thread's wait; nullptr detaches (before the platform
+  // layer shuts down) and returns only once no notify() can still call the
+  // old one.
+  void set_wake(void (*wake)()) {
+    wake_.store(wake);
+    while (waking_.load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  void notify() { notify(now_ns()); }
+
+  // New data that arrived at `since_ns` (steady ns), e.g. stamped on the
+  // network thread before it waited in an observer queue; latency is
+  // measured from the oldest unshown arrival.
+  void notify(int64_t since_ns) {
+    since_ns = std::max<int64_t>(since_ns, 1); // 0 means nothing pending
+    int64_t pending = pending_since_.load(std::memory_order_acquire);
+    while ((pending == 0 || since_ns < pending) &&
+           !pending_since_.compare_exchange_weak(pending, since_ns,
+                                                 std::memory_order_acq_rel)) {
+    }
+    // Counted before loading wake_, so set_wake() either hides the old
+    // function from this call or waits for it (both sides seq_cst).
+    waking_.fetch_add(1);
+    if (auto *wake = wake_.load()) wake();
+    waking_.fetch_sub(1);
+  }
+
+  // Render the next frame no later than `when`; the earliest request wins.
+  void request_by(steady::time_point when) { requested_ = std::min(requested_, when); }
+  // Keep rendering at the frame cap (drags, held keys).
+  void request_animation() { request_by(steady::time_point::min()); }
+
+  // Blocks in `wait_events(timeout_sec)` until a frame is due.
+  template <class WaitFn> void wait(WaitFn &&wait_events) {
+    const auto wait_start = steady::now();
+    auto due = last_frame_ + max_interval_;
+    if (settle_ > 0 || pending_since_.load(std::memory_order_acquire) != 0) {
+      due = last_frame_;
+    }
+    due = std::max(std::min(due, requested_), last_frame_ + min_interval_);
+    if (wait_start < due) {
+      wait_events(std::chrono::duration<double>(due - wait_start).count());
+      if (steady::now() < due) {
+        // Woken early by input or new data: render it, but not above the cap.
+        // Input also gets a few more frames for ImGui to settle hover and
+        // layout.
+        if (pending_since_.load(std::memory_order_acquire) == 0) settle_ = kSettleFrames;
+        std::this_thread::sleep_until(last_frame_ + min_interval_);
+      }
+    }
+
+    last_frame_ = steady::now();
+    requested_ = steady::time_point::max();
+    frame_data_since_ = pending_since_.exchange(0, std::memory_order_acq_rel);
+    window_.idle += last_frame_ - wait_start;
+  }
+
+  // Call right after the buffer swap.
+  void frame_presented() {
+    const auto now = steady::now();
+    if (settle_ > 0) --settle_;
+    ++window_.frames;
+    if (frame_data_since_ != 0) {
+      const double ms = static_cast<double>(now_ns() - frame_data_since_) / 1e6;
+      window_.latency_sum_ms += ms;
+      window_.latency_max_ms = std::max(window_.latency_max_ms, ms);
+      ++window_.latency_count;
+      frame_data_since_ = 0;
+    }
+
+    const double wall = std::chrono::duration<double>(now - window_.start).count();
+    if (wall < 1.0) return;
+    const std::clock_t cpu_now = std::clock();
+    Stats s;
+    s.fps = static_cast<double>(window_.frames) / wall;
+    s.idle = std::chrono::duration<double>(window_.idle).count() / wall;
+    s.cpu = static_cast<double>(cpu_now - window_.cpu_start) / CLOCKS_PER_SEC / wall;
+    if (window_.latency_count > 0) {
+      s.latency_avg_ms = window_.latency_sum_ms / static_cast<double>(window_.latency_count);
+      s.latency_max_ms = window_.latency_max_ms;
+    }
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      s.frames = stats_.frames + window_.frames;
+      stats_ = s;
+    }
+    window_ = Window{};
+    window_.start = now;
+    window_.cpu_start = cpu_now;
+  }
+
+  // Figures over the last completed ~1 s window.
+  [[nodiscard]] Stats stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+  }
+
+private:
+  static constexpr int kSettleFrames = 3;
+
+  struct Window {
+    steady::time_point start = steady::now();
+    std::clock_t cpu_start = std::clock();
+    steady::duration idle{};
+    uint64_t frames = 0;
+    double latency_sum_ms = 0.0;
+    double latency_max_ms = 0.0;
+    uint64_t latency_count = 0;
+  };
+
+  static steady::duration interval(float fps, double fallback_sec) {
+    return std::chrono::duration_cast<steady::duration>(
+        std::chrono::duration<double>(fps > 0.0F ? 1.0 / fps : fallback_sec));
+  }
+  static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               steady::now().time_since_epoch())
+        .count();
+  }
+
+  float max_fps_ = 0.0F;
+  steady::duration min_interval_{};
+  steady::duration max_interval_ = interval(1.0F, 0.0);
+  std::atomic<void (*)()> wake_{nullptr};
+  std::atomic<int> waking_{0}; // notify() calls between loading and calling wake_
+  std::atomic<int64_t> pending_since_{0}; // steady ns of the oldest unshown notify()
+
+  // Render thread only.
+  steady::time_point last_frame_{};
+  steady::time_point requested_ = steady::time_point::max();
+  int64_t frame_data_since_ = 0;
+  int settle_ = kSettleFrames;
+  Window window_;
+
+  mutable std::mutex stats_mutex_;
+  Stats stats_;
+};
+
+} // namespace ui
+} // namespace px4ctrl
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "datas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace px4ctrl {
+namespace ui {
+
+// Trajectory upload. A timed waypoint list travels on its own topic
+// (TransportParas::trajectory_topic) in chunks of up to
+// kTrajectoryChunkPoints points, one TrajectoryChunkHeader followed by
+// `count` TrajectoryPoint per message, so a 1000-point path is 4 messages
+// instead of 1000 CHANGE_HOVER_POS. The server answers each chunk with a
+// TrajectoryAck on trajectory_ack_topic carrying the first chunk it still
+// misses; the client resends from there until the ack says COMPLETE.
+inline constexpr uint32_t kTrajectoryMagic = 0x54344350;    // "PC4T" little-endian
+inline constexpr uint32_t kTrajectoryAckMagic = 0x41344350; // "PC4A" little-endian
+inline constexpr uint16_t kTrajectoryChunkPoints = 256;
+
+struct TrajectoryPoint {
+  float t;      // s from trajectory start, non-decreasing
+  float pos[3]; // world frame, m
+  float yaw;    // rad
+};
+
+enum TrajectoryFlags : uint8_t {
+  TRAJECTORY_START_ON_COMPLETE = 1, // follow it as soon as every chunk arrived
+};
+
+struct TrajectoryChunkHeader {
+  uint32_t magic;
+  uint32_t upload_id;    // fresh per upload; chunks of any other upload are dropped
+  uint32_t total_points;
+  uint32_t first_point;  // index of this chunk's first point
+  uint16_t seq;          // chunk index
+  uint16_t chunk_count;
+  uint16_t count;        // points in this chunk
+  uint8_t id;            // drone
+  uint8_t flags;         // TrajectoryFlags
+  uint64_t timestamp;    // ms, like ClientPayload::timestamp
+};
+
+enum class TrajectoryAckStatus : uint8_t {
+  RECEIVING, // next_seq is the first chunk still missing
+  COMPLETE,
+  REJECTED,  // invalid, too long, or the drone cannot follow it now
+};
+
+static constexpr const char *TrajectoryAckStatusName[] = {
+    "RECEIVING", "COMPLETE", "REJECTED",
+};
+
+struct TrajectoryAck {
+  uint32_t magic;
+  uint32_t upload_id;
+  uint32_t received_points;
+  uint16_t next_seq;
+  uint8_t id;
+  TrajectoryAckStatus status;
+  uint64_t timestamp; // ms
+};
+
+static_assert(std::is_trivially_copyable_v<TrajectoryPoint> &&
+                  std::is_trivially_copyable_v<TrajectoryChunkHeader> &&
+                  std::is_trivially_copyable_v<TrajectoryAck>,
+              "Trajectory messages must be trivially copyable for wire transport");
+static_assert(sizeof(TrajectoryPoint) == 20, "TrajectoryPoint wire size changed");
+static_assert(sizeof(TrajectoryChunkHeader) == 32, "TrajectoryChunkHeader wire size changed");
+static_assert(sizeof(TrajectoryAck) == 24, "TrajectoryAck wire size changed");
+
+// Splits `points` into ready-to-publish chunk messages.
+inline std::vector<std::vector<uint8_t>>
+encode_trajectory(uint8_t id, uint32_t upload_id, const std::vector<TrajectoryPoint> &points,
+                  uint8_t flags, uint64_t timestamp) {
+  const size_t chunk_count =
+      std::max<size_t>(1, (points.size() + kTrajectoryChunkPoints - 1) / kTrajectoryChunkPoints);
+  std::vector<std::vector<uint8_t>> chunks;
+  chunks.reserve(chunk_count);
+  for (size_t seq = 0; seq < chunk_count; ++seq) {
+    const size_t first = seq * kTrajectoryChunkPoints;
+    const size_t count = std::min<size_t>(kTrajectoryChunkPoints, points.size() - first);
+    TrajectoryChunkHeader header{};
+    header.magic = kTrajectoryMagic;
+    header.upload_id = upload_id;
+    header.total_points = static_cast<uint32_t>(points.size());
+    header.first_point = static_cast<uint32_t>(first);
+    header.seq = static_cast<uint16_t>(seq);
+    header.chunk_count = static_cast<uint16_t>(chunk_count);
+    header.count = static_cast<uint16_t>(count);
+    header.id = id;
+    header.flags = flags;
+    header.timestamp = timestamp;
+
+    auto &chunk = chunks.emplace_back(sizeof(header) + count * sizeof(TrajectoryPoint));
+    std::memcpy(chunk.data(), &header, sizeof(header));
+    if (count > 0) {
+      std::memcpy(chunk.data() + sizeof(header), points.data() + first,
+                  count * sizeof(TrajectoryPoint));
+    }
+  }
+  return chunks;
+}
+
+inline bool decode_trajectory_ack(const uint8_t *data, size_t size, TrajectoryAck &out) {
+  if (size != sizeof(TrajectoryAck)) return false;
+  std::memcpy(&out, data, sizeof(out));
+  return out.magic == kTrajectoryAckMagic &&
+         static_cast<size_t>(out.status) < std::size(TrajectoryAckStatusName);
+}
+
+// Sets each point's time from the path length at constant `speed` (m/s),
+// starting at 0.
+inline void time_trajectory(std::vector<TrajectoryPoint> &points, float speed) {
+  speed = std::max(speed, 0.01F);
+  float t = 0.0F;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (i > 0) {
+      const float dx = points[i].pos[0] - points[i - 1].pos[0];
+      const float dy = points[i].pos[1] - points[i - 1].pos[1];
+      const float dz = points[i].pos[2] - points[i - 1].pos[2];
+      t += std::sqrt(dx * dx + dy * dy + dz * dz) / speed;
+    }
+    points[i].t = t;
+  }
+}
+
+// Reads a path from CSV, one waypoint per line, '#' comments and a header
+// line allowed:
+//   t,x,y,z,yaw  timed waypoints, used as is
+//   x,y,z[,yaw]  untimed, timed at `speed`; yaw defaults to `default_yaw`
+// Returns false with `error` set on the first bad line.
+inline bool load_trajectory_csv(const std::string &file, float speed, float default_yaw,
+                                std::vector<TrajectoryPoint> &out, std::string &error) {
+  std::ifstream ifs(file);
+  if (!ifs.is_open()) {
+    error = "cannot open " + file;
+    return false;
+  }
+  std::vector<TrajectoryPoint> points;
+  bool timed = false;
+  std::string line;
+  for (size_t line_no = 1; std::getline(ifs, line); ++line_no) {
+    const auto comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream fields(line);
+    std::vector<float> values;
+    for (float v = 0.0F; fields >> v;) values.push_back(v);
+    if (values.empty() && (fields.eof() || points.empty())) continue; // blank or header
+    if (!fields.eof()) {
+      error = "line " + std::to_string(line_no) + ": not a number";
+      return false;
+    }
+    const bool row_timed = values.size() == 5;
+    if (values.size() < 3 || values.size() > 5 || (!points.empty() && row_timed != timed)) {
+      error = "line " + std::to_string(line_no) + ": expected x,y,z[,yaw] or t,x,y,z,yaw";
+      return false;
+    }
+    timed = row_timed;
+    TrajectoryPoint p{};
+    const size_t base = timed ? 1 : 0;
+    p.t = timed ? values[0] : 0.0F;
+    p.pos[0] = values[base];
+    p.pos[1] = values[base + 1];
+    p.pos[2] = values[base + 2];
+    p.yaw = values.size() > base + 3 ? values[base + 3] : default_yaw;
+    if (timed && !points.empty() && p.t < points.back().t) {
+      error = "line " + std::to_string(line_no) + ": time goes backwards";
+      return false;
+    }
+    points.push_back(p);
+  }
+  if (points.empty()) {
+    error = "no waypoints in " + file;
+    return false;
+  }
+  if (!timed) time_trajectory(points, speed);
+  out = std::move(points);
+  return true;
+}
+
+} // namespace ui
+} // namespace px4ctrl
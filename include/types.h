@@ -1,10 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
-#include <functional>
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace px4ctrl {
 
@@ -35,9 +43,109 @@ inline clock::time_point from_uint64(const long &time) {
   return clock::time_point(std::chrono::milliseconds(time));
 }
 
-template <typename T> using Callback = std::function<void(const T &)>;
+// std::function replacement that stores the callable inline and never
+// allocates; callables larger than Capacity are rejected at compile time.
+template <typename Signature, size_t Capacity = 48> class InplaceFunction;
+
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+  InplaceFunction() = default;
+  InplaceFunction(std::nullptr_t) {}
+
+  template <typename F, typename Fn = std::decay_t<F>,
+            typename = std::enable_if_t<!std::is_same_v<Fn, InplaceFunction> &&
+                                        std::is_invocable_r_v<R, Fn &, Args...>>>
+  InplaceFunction(F &&f) {
+    static_assert(sizeof(Fn) <= Capacity,
+                  "Callable too large for InplaceFunction; capture less");
+    static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                  "Callable over-aligned for InplaceFunction");
+    static_assert(std::is_copy_constructible_v<Fn>,
+                  "InplaceFunction requires a copyable callable");
+    ::new (static_cast<void *>(m_storage)) Fn(std::forward<F>(f));
+    m_ops = &kOps<Fn>;
+  }
+
+  InplaceFunction(const InplaceFunction &other) : m_ops(other.m_ops) {
+    if (m_ops != nullptr) {
+      m_ops->copy(m_storage, other.m_storage);
+    }
+  }
+
+  InplaceFunction(InplaceFunction &&other) noexcept : m_ops(other.m_ops) {
+    if (m_ops != nullptr) {
+      m_ops->move(m_storage, other.m_storage);
+    }
+  }
+
+  InplaceFunction &operator=(const InplaceFunction &other) {
+    if (this != &other) {
+      reset();
+      if (other.m_ops != nullptr) {
+        other.m_ops->copy(m_storage, other.m_storage);
+        m_ops = other.m_ops;
+      }
+    }
+    return *this;
+  }
+
+  InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.m_ops != nullptr) {
+        other.m_ops->move(m_storage, other.m_storage);
+        m_ops = other.m_ops;
+      }
+    }
+    return *this;
+  }
+
+  ~InplaceFunction() { reset(); }
+
+  inline R operator()(Args... args) const {
+    return m_ops->invoke(const_cast<unsigned char *>(m_storage),
+                         std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return m_ops != nullptr; }
+
+private:
+  struct Ops {
+    R (*invoke)(void *, Args...);
+    void (*copy)(void *, const void *);
+    void (*move)(void *, void *);
+    void (*destroy)(void *);
+  };
+
+  template <typename Fn>
+  static constexpr Ops kOps = {
+      [](void *self, Args... args) -> R {
+        return (*static_cast<Fn *>(self))(std::forward<Args>(args)...);
+      },
+      [](void *dst, const void *src) {
+        ::new (dst) Fn(*static_cast<const Fn *>(src));
+      },
+      [](void *dst, void *src) {
+        ::new (dst) Fn(std::move(*static_cast<Fn *>(src)));
+      },
+      [](void *self) { static_cast<Fn *>(self)->~Fn(); },
+  };
+
+  alignas(std::max_align_t) unsigned char m_storage[Capacity];
+  const Ops *m_ops = nullptr;
+
+  inline void reset() {
+    if (m_ops != nullptr) {
+      m_ops->destroy(m_storage);
+      m_ops = nullptr;
+    }
+  }
+};
+
+template <typename T> using Callback = InplaceFunction<void(const T &)>;
 class Observer;
-using FuncUnobserve = std::function<void(const Observer *)>;
+using FuncUnobserve = InplaceFunction<void(const Observer *)>;
 
 class Observer {
 public:
@@ -51,42 +159,174 @@ private:
   FuncUnobserve m_func;
 };
 
+// Latest-value cell for trivially copyable T. Readers copy the value word by
+// word between two reads of an even sequence number and retry if a writer
+// ran in between, so they never block the writer and never see a torn value.
+template <typename T> class SeqlockValue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqlockValue requires a trivially copyable type");
+
+public:
+  SeqlockValue() { store(T{}); }
+
+  inline T load() const {
+    uint64_t words[kWords];
+    for (;;) {
+      const uint64_t seq0 = m_seq.load(std::memory_order_acquire);
+      if ((seq0 & 1U) != 0) {
+        continue;
+      }
+      for (size_t i = 0; i < kWords; ++i) {
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_seq.load(std::memory_order_relaxed) == seq0) {
+        break;
+      }
+    }
+    T out;
+    std::memcpy(&out, words, sizeof(T));
+    return out;
+  }
+
+  inline void store(const T &value) {
+    const auto *src = reinterpret_cast<const unsigned char *>(&value);
+
+    // An odd sequence doubles as the writer lock, so concurrent writers
+    // serialize without a separate mutex. Taking it must acquire the previous
+    // writer's seq + 2 release, or the two writers' word stores are unordered
+    // and the result can mix both values.
+    uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    while ((seq & 1U) != 0 ||
+           !m_seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      seq = m_seq.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) {
+      uint64_t word = 0;
+      std::memcpy(&word, src + i * sizeof(word),
+                  std::min(sizeof(word), sizeof(T) - i * sizeof(word)));
+      m_words[i].store(word, std::memory_order_relaxed);
+    }
+    m_seq.store(seq + 2, std::memory_order_release);
+  }
+
+private:
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> m_seq{0};
+  std::array<std::atomic<uint64_t>, kWords> m_words{};
+};
+
+// Fallback latest-value cell for types that cannot be copied word by word.
+template <typename T> class LockedValue {
+public:
+  inline T load() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_data;
+  }
+
+  inline void store(const T &value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_data = value;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  T m_data{};
+};
+
+// post() reads an immutable snapshot of the observer list through one atomic
+// pointer, so it never takes a lock. observe()/removeObserver() copy the list,
+// publish the new snapshot and retire the old one. A retired snapshot is freed
+// once no post() is in flight: by the writer if none is running, else by the
+// next post() to finish with no other in flight. A callback may still run
+// once from a post() that started before its removal.
 template <typename T> class Observable {
 public:
-  inline const T &value() const { return m_data; }
+  Observable() = default;
+  Observable(const Observable &) = delete;
+  Observable &operator=(const Observable &) = delete;
+
+  ~Observable() { delete m_snapshot.load(); }
+
+  // Consistent copy of the last posted value; lock-free for trivially
+  // copyable T, so the render thread never blocks the network thread.
+  inline T value() const { return m_latest.load(); }
 
   inline void post(const T &data) {
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_data = data;
-    }
+    m_latest.store(data);
 
-    for (auto it = m_callbacks.begin(); it != m_callbacks.end(); it++) {
-      it->second(m_data);
+    m_posting.fetch_add(1);
+    const Snapshot *snapshot = m_snapshot.load();
+    for (const auto &entry : *snapshot) {
+      entry.second(data);
+    }
+    if (m_posting.fetch_sub(1) == 1 && m_has_retired.load(std::memory_order_relaxed)) {
+      reclaim();
     }
   }
 
   inline std::shared_ptr<Observer> observe(Callback<T> callback) {
     auto observer = std::make_shared<Observer>(
-        std::bind(&Observable<T>::removeObserver, this, std::placeholders::_1));
-    m_callbacks[observer.get()] = std::move(callback);
+        [this](const Observer *o) { removeObserver(o); });
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    auto next = std::make_unique<Snapshot>(*m_snapshot.load());
+    next->emplace_back(observer.get(), std::move(callback));
+    publish(std::move(next));
     return observer;
   }
 
 private:
   friend class Observer;
 
-  std::mutex m_mutex;
-  T m_data{};
-  std::map<Observer *, Callback<T>> m_callbacks;
+  using Snapshot = std::vector<std::pair<const Observer *, Callback<T>>>;
+
+  std::conditional_t<std::is_trivially_copyable_v<T>, SeqlockValue<T>, LockedValue<T>>
+      m_latest;
+
+  std::mutex m_write_mutex;
+  std::atomic<const Snapshot *> m_snapshot{new Snapshot()};
+  std::atomic<int> m_posting{0}; // post() calls between load and last callback
+  std::atomic<bool> m_has_retired{false};
+  std::vector<std::unique_ptr<const Snapshot>> m_retired; // guarded by m_write_mutex
 
   inline void removeObserver(const Observer *observer) {
-    for (auto it = m_callbacks.begin(); it != m_callbacks.end(); it++) {
-      if (it->first == observer) {
-        m_callbacks.erase(it);
-        return;
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    const Snapshot *current = m_snapshot.load();
+    auto next = std::make_unique<Snapshot>();
+    next->reserve(current->size());
+    for (const auto &entry : *current) {
+      if (entry.first != observer) {
+        next->push_back(entry);
       }
     }
+    if (next->size() != current->size()) {
+      publish(std::move(next));
+    }
+  }
+
+  // Caller holds m_write_mutex.
+  inline void publish(std::unique_ptr<Snapshot> next) {
+    m_retired.emplace_back(m_snapshot.exchange(next.release()));
+    // Any post() starting after the exchange sees the new snapshot, so with
+    // none in flight nothing can still hold a retired one.
+    if (m_posting.load() == 0) {
+      m_retired.clear();
+    }
+    m_has_retired.store(!m_retired.empty(), std::memory_order_relaxed);
+  }
+
+  // Called by a post() that finished with no other in flight. try_lock keeps
+  // the posting thread from ever blocking on a writer, which checks again
+  // after its own exchange.
+  inline void reclaim() {
+    std::unique_lock<std::mutex> lock(m_write_mutex, std::try_to_lock);
+    if (lock.owns_lock() && m_posting.load() == 0) {
+      m_retired.clear();
+      m_has_retired.store(false, std::memory_order_relaxed);
+    }
   }
 };
 
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "datas.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace px4ctrl {
+namespace ui {
+namespace wire {
+
+// Versioned ServerPayload frames start with this header. Frames without it
+// predate versioning and are decoded as schema version 1.
+inline constexpr uint32_t kServerMagic = 0x53344350; // "PC4S" little-endian
+inline constexpr uint16_t kSchemaVersion = 1;
+
+struct WireHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t payload_size;
+};
+
+static_assert(sizeof(WireHeader) == 8, "WireHeader wire size must stay 8 bytes");
+
+template <typename> struct member_type;
+template <typename S, typename M> struct member_type<M S::*> {
+  using type = M;
+};
+template <auto Member>
+using member_type_t = typename member_type<decltype(Member)>::type;
+
+// One field table entry: the member at WireOffset on the wire, stored as
+// WireT, maps onto ServerPayload::*Member (at NativeOffset in memory).
+template <auto Member, size_t WireOffset, size_t NativeOffset,
+          typename WireT = member_type_t<Member>>
+struct Field {
+  using type = member_type_t<Member>;
+  static constexpr size_t wire_offset = WireOffset;
+  static constexpr size_t wire_end = WireOffset + sizeof(WireT);
+  static constexpr bool native = WireOffset == NativeOffset &&
+                                 std::is_same_v<WireT, type>;
+
+  static_assert(std::is_same_v<WireT, type> || std::is_arithmetic_v<type>,
+                "Only scalar fields can change wire type between versions");
+
+  static void read(const uint8_t *src, ServerPayload &out) {
+    if constexpr (std::is_same_v<WireT, type>) {
+      std::memcpy(&(out.*Member), src + WireOffset, sizeof(type));
+    } else {
+      WireT v;
+      std::memcpy(&v, src + WireOffset, sizeof(WireT));
+      out.*Member = static_cast<type>(v);
+    }
+  }
+};
+
+#define PX4_WIRE_FIELD(member, wire_offset, ...)                               \
+  ::px4ctrl::ui::wire::Field<&::px4ctrl::ui::ServerPayload::member,            \
+                             wire_offset,                                      \
+                             offsetof(::px4ctrl::ui::ServerPayload, member)    \
+                                 __VA_OPT__(, ) __VA_ARGS__>
+
+// A complete wire layout. Fields absent from the table keep their
+// value-initialized defaults after decoding; a layout identical to the
+// in-memory struct collapses into a single memcpy.
+template <uint16_t Version, size_t WireSize, typename... Fields> struct Layout {
+  static constexpr uint16_t version = Version;
+  static constexpr size_t size = WireSize;
+  static constexpr bool native =
+      WireSize == sizeof(ServerPayload) && (Fields::native && ...);
+
+  static_assert(((Fields::wire_end <= WireSize) && ...),
+                "Field table entry exceeds the layout wire size");
+
+  static void decode(const uint8_t *src, ServerPayload &out) {
+    if constexpr (native) {
+      std::memcpy(&out, src, sizeof(ServerPayload));
+    } else {
+      out = ServerPayload{};
+      (Fields::read(src, out), ...);
+    }
+  }
+};
+
+// Schema v1: the original 240-byte layout.
+using ServerLayoutV1 = Layout<
+    1, 240, PX4_WIRE_FIELD(id, 0), PX4_WIRE_FIELD(timestamp, 8),
+    PX4_WIRE_FIELD(pos, 16), PX4_WIRE_FIELD(vel, 28),
+    PX4_WIRE_FIELD(omega, 40), PX4_WIRE_FIELD(quat, 52),
+    PX4_WIRE_FIELD(thrust_setpoint, 68), PX4_WIRE_FIELD(omega_setpoint, 72),
+    PX4_WIRE_FIELD(battery_voltage, 84), PX4_WIRE_FIELD(mission_phase, 88),
+    PX4_WIRE_FIELD(offboard_state, 92), PX4_WIRE_FIELD(armed_state, 96),
+    PX4_WIRE_FIELD(thrust_map, 100), PX4_WIRE_FIELD(hover_pos, 112),
+    PX4_WIRE_FIELD(hover_quat, 124), PX4_WIRE_FIELD(odom_hz, 140),
+    PX4_WIRE_FIELD(cmdctrl_hz, 144), PX4_WIRE_FIELD(telemetry_seq, 148),
+    PX4_WIRE_FIELD(guard_flags, 152), PX4_WIRE_FIELD(odom_age_ms, 156),
+    PX4_WIRE_FIELD(client_cmd_age_ms, 160),
+    PX4_WIRE_FIELD(battery_remaining, 164), PX4_WIRE_FIELD(speed_norm, 168),
+    PX4_WIRE_FIELD(tilt_deg, 172), PX4_WIRE_FIELD(roll_deg, 176),
+    PX4_WIRE_FIELD(pitch_deg, 180), PX4_WIRE_FIELD(yaw_deg, 184),
+    PX4_WIRE_FIELD(cmd_age_ms, 188), PX4_WIRE_FIELD(omega_min, 192),
+    PX4_WIRE_FIELD(omega_max, 196), PX4_WIRE_FIELD(geofence_min, 200),
+    PX4_WIRE_FIELD(geofence_max, 212), PX4_WIRE_FIELD(max_roll_deg, 224),
+    PX4_WIRE_FIELD(max_pitch_deg, 228), PX4_WIRE_FIELD(max_yaw_deg, 232),
+    PX4_WIRE_FIELD(enable_geofence, 236),
+    PX4_WIRE_FIELD(enable_attitude_fence, 237), PX4_WIRE_FIELD(use_rc, 238),
+    PX4_WIRE_FIELD(reserved0, 239)>;
+
+static_assert(ServerLayoutV1::native,
+              "Schema v1 must match the in-memory ServerPayload layout");
+
+using DecodeFn = void (*)(const uint8_t *, ServerPayload &);
+
+struct DecoderEntry {
+  size_t size = 0;
+  DecodeFn decode = nullptr;
+};
+
+// Decoder table indexed by schema version. Append new layouts here when the
+// server bumps kSchemaVersion; older entries must never change.
+template <typename... Layouts> constexpr auto make_decoder_table() {
+  constexpr uint16_t max_version = std::max({Layouts::version...});
+  std::array<DecoderEntry, max_version + 1> table{};
+  ((table[Layouts::version] = DecoderEntry{Layouts::size, &Layouts::decode}),
+   ...);
+  return table;
+}
+
+inline constexpr auto kServerDecoders = make_decoder_table<ServerLayoutV1>();
+
+static_assert(kServerDecoders.size() == kSchemaVersion + 1,
+              "kSchemaVersion must name the newest decoder table entry");
+
+inline constexpr size_t max_frame_size() {
+  size_t size = 0;
+  for (const auto &entry : kServerDecoders) {
+    size = std::max(size, entry.size);
+  }
+  return sizeof(WireHeader) + size;
+}
+
+// Decodes a raw ServerPayload frame of any known schema version into the
+// current in-memory struct. Returns false if the frame matches no layout.
+inline bool decode_server_payload(const uint8_t *data, size_t size,
+                                  ServerPayload &out) {
+  if (size >= sizeof(WireHeader)) {
+    WireHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic == kServerMagic) {
+      if (header.version >= kServerDecoders.size()) {
+        return false;
+      }
+      const auto &entry = kServerDecoders[header.version];
+      if (entry.decode == nullptr || header.payload_size != entry.size ||
+          size - sizeof(WireHeader) != entry.size) {
+        return false;
+      }
+      entry.decode(data + sizeof(WireHeader), out);
+      return true;
+    }
+  }
+
+  if (size == ServerLayoutV1::size) {
+    ServerLayoutV1::decode(data, out);
+    return true;
+  }
+  return false;
+}
+
+} // namespace wire
+} // namespace ui
+} // namespace px4ctrl
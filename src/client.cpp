@@ -8,6 +8,7 @@
 #include <cstring>
 #include <imgui.h>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 
 namespace px4ctrl {
@@ -67,15 +68,14 @@ bool payload_to_bytes(const void *data, const size_t size, z_owned_bytes_t &byte
                                size) >= 0;
 }
 
-bool bytes_to_struct(const z_loaned_bytes_t *bytes, void *out, size_t out_size) {
-  const auto size = z_bytes_len(bytes);
-  if (size != out_size) {
+bool bytes_to_buffer(const z_loaned_bytes_t *bytes, uint8_t *out, size_t capacity,
+                     size_t &size) {
+  size = z_bytes_len(bytes);
+  if (size > capacity) {
     return false;
   }
   z_bytes_reader_t reader = z_bytes_get_reader(bytes);
-  const auto copied = z_bytes_reader_read(&reader, reinterpret_cast<uint8_t *>(out),
-                                          out_size);
-  return copied == out_size;
+  return z_bytes_reader_read(&reader, out, size) == size;
 }
 
 std::string bytes_to_string(const z_loaned_bytes_t *bytes) {
@@ -150,6 +150,191 @@ ImVec4 log_color_for_level(const int level) {
   }
   return ImGui::GetStyleColorVec4(ImGuiCol_Text);
 }
+
+// Background, grid, tick labels and zero line shared by the time-series
+// plots; must be constructed inside the plot child window. With `decorate`
+// false only the layout is computed (the decorations were replayed).
+struct TimePlotFrame {
+  static constexpr float kPadL = 42.0F;
+  static constexpr float kPadR = 10.0F;
+  static constexpr float kPadT = 8.0F;
+  static constexpr float kPadB = 18.0F;
+
+  ImDrawList *draw = nullptr;
+  ImVec2 p0;
+  ImVec2 p1;
+  float plot_w = 1.0F;
+  float plot_h = 1.0F;
+  double t_first = 0.0;
+  double span = 1.0;
+  bool single_instant = false;
+  float min_v = 0.0F;
+  float max_v = 1.0F;
+
+  TimePlotFrame(double t_begin, double t_end, float lo, float hi, bool decorate = true)
+      : draw(ImGui::GetWindowDrawList()), t_first(t_begin),
+        span(std::max(1e-6, t_end - t_begin)), single_instant(t_end - t_begin < 1e-6),
+        min_v(lo), max_v(hi) {
+    if (std::abs(max_v - min_v) < 1e-6F) {
+      min_v -= 1.0F;
+      max_v += 1.0F;
+    }
+    const ImVec2 avail = ImGui::GetContentRegionAvail();
+    p0 = ImGui::GetCursorScreenPos();
+    p1 = ImVec2(p0.x + avail.x, p0.y + avail.y);
+    plot_w = std::max(1.0F, avail.x - kPadL - kPadR);
+    plot_h = std::max(1.0F, avail.y - kPadT - kPadB);
+    if (!decorate) return;
+
+    draw->AddRectFilled(p0, p1, IM_COL32(20, 20, 24, 255));
+    draw->AddRect(p0, p1, IM_COL32(80, 80, 80, 255));
+
+    const int kTickCount = (plot_h >= 130.0F) ? 4 : 3;
+    for (int i = 0; i <= kTickCount; ++i) {
+      const float t = static_cast<float>(i) / static_cast<float>(kTickCount);
+      const float x = p0.x + kPadL + t * plot_w;
+      const float y = p1.y - kPadB - t * plot_h;
+
+      draw->AddLine(ImVec2(x, p0.y + kPadT), ImVec2(x, p1.y - kPadB),
+                    IM_COL32(55, 55, 65, 180), 1.0F);
+      draw->AddLine(ImVec2(p0.x + kPadL, y), ImVec2(p1.x - kPadR, y),
+                    IM_COL32(55, 55, 65, 180), 1.0F);
+
+      const float y_val = min_v + t * (max_v - min_v);
+      char y_tick[24];
+      std::snprintf(y_tick, sizeof(y_tick), "%.2f", y_val);
+      draw->AddText(ImVec2(p0.x + 2.0F, y - 7.0F),
+                    IM_COL32(150, 150, 160, 220), y_tick);
+
+      const float sec_ago = static_cast<float>((1.0 - t) * (t_end - t_begin));
+      char x_tick[24];
+      if (sec_ago < 0.05F) {
+        std::snprintf(x_tick, sizeof(x_tick), "0s");
+      } else if (sec_ago >= 120.0F) {
+        std::snprintf(x_tick, sizeof(x_tick), "-%.1fm", sec_ago / 60.0F);
+      } else if (sec_ago >= 10.0F) {
+        std::snprintf(x_tick, sizeof(x_tick), "-%.0fs", sec_ago);
+      } else {
+        std::snprintf(x_tick, sizeof(x_tick), "-%.1fs", sec_ago);
+      }
+      draw->AddText(ImVec2(x - 12.0F, p1.y - kPadB + 2.0F),
+                    IM_COL32(150, 150, 160, 220), x_tick);
+    }
+
+    if (min_v < 0.0F && max_v > 0.0F) {
+      const float t0 = static_cast<float>((0.0 - min_v) / (max_v - min_v));
+      const float y0 = p1.y - kPadB - t0 * plot_h;
+      draw->AddLine(ImVec2(p0.x + kPadL, y0), ImVec2(p1.x - kPadR, y0),
+                    IM_COL32(110, 110, 135, 220), 1.4F);
+    }
+  }
+
+  [[nodiscard]] ImVec2 to_screen(double t, float v) const {
+    const float tx = single_instant ? 1.0F : static_cast<float>((t - t_first) / span);
+    const float ty = (v - min_v) / (max_v - min_v);
+    return ImVec2(p0.x + kPadL + tx * plot_w, p1.y - kPadB - ty * plot_h);
+  }
+};
+
+// Fixed plot bounds for channels that have natural limits; others auto-scale.
+void channel_bounds(ChannelId channel, const ServerPayload &drone, float &min_v,
+                    float &max_v) {
+  switch (channel) {
+  case ChannelId::POS_Z: {
+    const float z_range = drone.geofence_max[2] - drone.geofence_min[2];
+    const float z_margin = std::max(0.2f, z_range * 0.05f);
+    min_v = drone.geofence_min[2] - z_margin;
+    max_v = drone.geofence_max[2] + z_margin;
+    break;
+  }
+  case ChannelId::THRUST_SP:
+  case ChannelId::BATTERY_PCT:
+    min_v = 0.0F;
+    max_v = 1.0F;
+    break;
+  case ChannelId::OMEGA_SP_X:
+  case ChannelId::OMEGA_SP_Y:
+  case ChannelId::OMEGA_SP_Z: {
+    const float w_margin = (drone.omega_max - drone.omega_min) * 0.05f;
+    min_v = drone.omega_min - w_margin;
+    max_v = drone.omega_max + w_margin;
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+ImU32 channel_color(ChannelId channel) {
+  switch (channel) {
+  case ChannelId::POS_Z: return IM_COL32(80, 220, 100, 255);
+  case ChannelId::THRUST_SP: return IM_COL32(255, 200, 80, 255);
+  case ChannelId::OMEGA_SP_X: return IM_COL32(255, 100, 100, 255);
+  case ChannelId::OMEGA_SP_Y: return IM_COL32(80, 180, 255, 255);
+  case ChannelId::OMEGA_SP_Z: return IM_COL32(180, 130, 255, 255);
+  default: break;
+  }
+  static constexpr ImU32 kPalette[] = {
+      IM_COL32(120, 220, 220, 255), IM_COL32(230, 140, 200, 255),
+      IM_COL32(200, 200, 120, 255), IM_COL32(150, 160, 255, 255),
+  };
+  return kPalette[static_cast<size_t>(channel) % std::size(kPalette)];
+}
+
+ImU32 battery_color(float pct) {
+  return pct > 40.0f ? IM_COL32(80, 220, 120, 255) :
+         pct > 15.0f ? IM_COL32(255, 210, 80, 255) :
+                       IM_COL32(255, 80, 80, 255);
+}
+
+std::string guard_flags_text(uint32_t guard_flags) {
+  static constexpr const char *kGuardNames[] = {"MAVROS", "ODOM", "UI",      "BATT",    "GEO",
+                                                "ATT",    "VEL",  "ODOM_HZ", "RC_LOST", "RC_REQ"};
+  std::string flags;
+  for (size_t bit = 0; bit < std::size(kGuardNames); ++bit) {
+    if (guard_flags & (1U << bit)) {
+      flags += kGuardNames[bit];
+      flags += ' ';
+    }
+  }
+  return flags;
+}
+
+ImU32 drone_color(uint8_t id) {
+  static constexpr ImU32 kPalette[] = {
+      IM_COL32(80, 220, 100, 255),  IM_COL32(255, 200, 80, 255),
+      IM_COL32(80, 180, 255, 255),  IM_COL32(255, 110, 110, 255),
+      IM_COL32(190, 140, 255, 255), IM_COL32(120, 220, 220, 255),
+      IM_COL32(230, 140, 200, 255), IM_COL32(200, 200, 120, 255),
+  };
+  return kPalette[id % std::size(kPalette)];
+}
+
+// GLFW_GAMEPAD_AXIS_* / GLFW_GAMEPAD_BUTTON_* indices of GamepadSample.
+constexpr size_t kPadLeftX = 0;
+constexpr size_t kPadLeftY = 1;
+constexpr size_t kPadRightX = 2;
+constexpr size_t kPadRightY = 3;
+constexpr size_t kPadButtonA = 0;
+
+// Unacknowledged trajectory chunks (go-back-N from the first one the server
+// misses) and group commands (to the members still silent) are resent after
+// this long without progress.
+constexpr double kAckTimeoutMs = 300.0;
+constexpr int kAckMaxRetries = 5;
+constexpr size_t kGroupHistory = 8; // finished group commands kept for display
+constexpr const char *kUploadPhaseName[] = {"idle", "sending", "complete", "rejected",
+                                            "no ack"};
+
+double elapsed_ms(clock::time_point from, clock::time_point to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+RedrawScheduler::steady::time_point steady_after_ms(double ms) {
+  return RedrawScheduler::steady::now() +
+         std::chrono::duration_cast<RedrawScheduler::steady::duration>(
+             std::chrono::duration<double, std::milli>(ms));
+}
 } // namespace
 
 // --- Phase badge colors and rendering ---
@@ -197,7 +382,10 @@ void ImguiClient::RenderOnOffBadge(bool on, const char *label_on, const char *la
   ImGui::Dummy(size);
 }
 
-Px4Client::Px4Client(const TransportParas &paras) : paras_(paras) {
+Px4Client::Px4Client(const TransportParas &paras)
+    : observer_pool_(std::make_unique<ThreadPool>(paras.observer_threads)),
+      server_data(*observer_pool_), log_data(*observer_pool_), trajectory_ack(*observer_pool_),
+      group_ack(*observer_pool_), paras_(paras) {
   if (paras_.backend != CommBackend::ZENOH) {
     throw std::runtime_error("Only zenoh backend is supported");
   }
@@ -206,6 +394,10 @@ Px4Client::Px4Client(const TransportParas &paras) : paras_(paras) {
   z_internal_null(&client_pub_);
   z_internal_null(&server_sub_);
   z_internal_null(&log_sub_);
+  z_internal_null(&trajectory_pub_);
+  z_internal_null(&trajectory_ack_sub_);
+  z_internal_null(&group_pub_);
+  z_internal_null(&group_ack_sub_);
 
   if (!init_zenoh()) {
     throw std::runtime_error("Px4Client init failed");
@@ -282,13 +474,87 @@ bool Px4Client::init_zenoh() {
     return false;
   }
 
+  z_view_keyexpr_t trajectory_key;
+  if (z_view_keyexpr_from_str(&trajectory_key, paras_.trajectory_topic.c_str()) < 0) {
+    spdlog::error("Invalid trajectory topic keyexpr: {}", paras_.trajectory_topic);
+    close_zenoh();
+    return false;
+  }
+  if (z_declare_publisher(z_loan(session_), &trajectory_pub_, z_loan(trajectory_key),
+                          nullptr) < 0) {
+    spdlog::error("Failed to declare trajectory publisher on {}", paras_.trajectory_topic);
+    close_zenoh();
+    return false;
+  }
+
+  z_owned_closure_sample_t ack_closure;
+  z_internal_null(&ack_closure);
+  z_closure_sample(&ack_closure, Px4Client::trajectory_ack_callback, nullptr, this);
+
+  z_view_keyexpr_t ack_key;
+  if (z_view_keyexpr_from_str(&ack_key, paras_.trajectory_ack_topic.c_str()) < 0) {
+    spdlog::error("Invalid trajectory ack topic keyexpr: {}", paras_.trajectory_ack_topic);
+    close_zenoh();
+    return false;
+  }
+  if (z_declare_subscriber(z_loan(session_), &trajectory_ack_sub_, z_loan(ack_key),
+                           z_move(ack_closure), nullptr) < 0) {
+    spdlog::error("Failed to declare trajectory ack subscriber on {}",
+                  paras_.trajectory_ack_topic);
+    close_zenoh();
+    return false;
+  }
+
+  z_view_keyexpr_t group_key;
+  if (z_view_keyexpr_from_str(&group_key, paras_.group_topic.c_str()) < 0) {
+    spdlog::error("Invalid group topic keyexpr: {}", paras_.group_topic);
+    close_zenoh();
+    return false;
+  }
+  if (z_declare_publisher(z_loan(session_), &group_pub_, z_loan(group_key), nullptr) < 0) {
+    spdlog::error("Failed to declare group publisher on {}", paras_.group_topic);
+    close_zenoh();
+    return false;
+  }
+
+  z_owned_closure_sample_t group_ack_closure;
+  z_internal_null(&group_ack_closure);
+  z_closure_sample(&group_ack_closure, Px4Client::group_ack_callback, nullptr, this);
+
+  z_view_keyexpr_t group_ack_key;
+  if (z_view_keyexpr_from_str(&group_ack_key, paras_.group_ack_topic.c_str()) < 0) {
+    spdlog::error("Invalid group ack topic keyexpr: {}", paras_.group_ack_topic);
+    close_zenoh();
+    return false;
+  }
+  if (z_declare_subscriber(z_loan(session_), &group_ack_sub_, z_loan(group_ack_key),
+                           z_move(group_ack_closure), nullptr) < 0) {
+    spdlog::error("Failed to declare group ack subscriber on {}", paras_.group_ack_topic);
+    close_zenoh();
+    return false;
+  }
+
   ok_.store(true);
-  spdlog::info("Zenoh client ready, pub:{}, sub:{}, log:{}", paras_.client_topic,
-               paras_.server_topic, paras_.log_topic);
+  spdlog::info("Zenoh client ready, pub:{}, sub:{}, log:{}, trajectory:{}/{}, group:{}/{}",
+               paras_.client_topic, paras_.server_topic, paras_.log_topic,
+               paras_.trajectory_topic, paras_.trajectory_ack_topic, paras_.group_topic,
+               paras_.group_ack_topic);
   return true;
 }
 
 void Px4Client::close_zenoh() {
+  if (z_internal_check(group_ack_sub_)) {
+    (void)z_undeclare_subscriber(z_move(group_ack_sub_));
+  }
+  if (z_internal_check(group_pub_)) {
+    (void)z_undeclare_publisher(z_move(group_pub_));
+  }
+  if (z_internal_check(trajectory_ack_sub_)) {
+    (void)z_undeclare_subscriber(z_move(trajectory_ack_sub_));
+  }
+  if (z_internal_check(trajectory_pub_)) {
+    (void)z_undeclare_publisher(z_move(trajectory_pub_));
+  }
   if (z_internal_check(log_sub_)) {
     (void)z_undeclare_subscriber(z_move(log_sub_));
   }
@@ -320,6 +586,40 @@ void Px4Client::pub_client(const ClientPayload &payload) {
   }
 }
 
+void Px4Client::pub_trajectory(const std::vector<uint8_t> &chunk) {
+  if (!ok_.load()) {
+    return;
+  }
+
+  z_owned_bytes_t bytes;
+  z_internal_null(&bytes);
+  if (!payload_to_bytes(chunk.data(), chunk.size(), bytes)) {
+    spdlog::warn("Failed to serialize trajectory chunk");
+    return;
+  }
+
+  if (z_publisher_put(z_loan(trajectory_pub_), z_move(bytes), nullptr) < 0) {
+    spdlog::warn("Failed to publish trajectory chunk");
+  }
+}
+
+void Px4Client::pub_group(const std::vector<uint8_t> &message) {
+  if (!ok_.load()) {
+    return;
+  }
+
+  z_owned_bytes_t bytes;
+  z_internal_null(&bytes);
+  if (!payload_to_bytes(message.data(), message.size(), bytes)) {
+    spdlog::warn("Failed to serialize group command");
+    return;
+  }
+
+  if (z_publisher_put(z_loan(group_pub_), z_move(bytes), nullptr) < 0) {
+    spdlog::warn("Failed to publish group command");
+  }
+}
+
 void Px4Client::server_sample_callback(z_loaned_sample_t *sample, void *context) {
   auto *self = reinterpret_cast<Px4Client *>(context);
   if (self == nullptr) {
@@ -331,12 +631,15 @@ void Px4Client::server_sample_callback(z_loaned_sample_t *sample, void *context)
     return;
   }
 
+  std::array<uint8_t, wire::max_frame_size()> frame{};
+  size_t frame_size = 0;
   ServerPayload payload{};
-  if (!bytes_to_struct(payload_bytes, &payload, sizeof(payload))) {
-    spdlog::warn("ServerPayload size mismatch");
+  if (!bytes_to_buffer(payload_bytes, frame.data(), frame.size(), frame_size) ||
+      !wire::decode_server_payload(frame.data(), frame_size, payload)) {
+    spdlog::warn("Unrecognized ServerPayload frame ({} bytes)", frame_size);
     return;
   }
-  self->server_data.post(payload);
+  self->server_data.post(ServerSample{payload, steady_ns()});
 }
 
 void Px4Client::log_sample_callback(z_loaned_sample_t *sample, void *context) {
@@ -352,35 +655,100 @@ void Px4Client::log_sample_callback(z_loaned_sample_t *sample, void *context) {
   self->log_data.post(decode_remote_log(payload_bytes));
 }
 
+void Px4Client::trajectory_ack_callback(z_loaned_sample_t *sample, void *context) {
+  auto *self = reinterpret_cast<Px4Client *>(context);
+  if (self == nullptr) {
+    return;
+  }
+
+  const auto *payload_bytes = z_sample_payload(sample);
+  if (payload_bytes == nullptr) {
+    return;
+  }
+
+  std::array<uint8_t, sizeof(TrajectoryAck)> frame{};
+  size_t frame_size = 0;
+  TrajectoryAck ack{};
+  if (!bytes_to_buffer(payload_bytes, frame.data(), frame.size(), frame_size) ||
+      !decode_trajectory_ack(frame.data(), frame_size, ack)) {
+    spdlog::warn("Unrecognized TrajectoryAck frame ({} bytes)", frame_size);
+    return;
+  }
+  self->trajectory_ack.post(ack);
+}
+
+void Px4Client::group_ack_callback(z_loaned_sample_t *sample, void *context) {
+  auto *self = reinterpret_cast<Px4Client *>(context);
+  if (self == nullptr) {
+    return;
+  }
+
+  const auto *payload_bytes = z_sample_payload(sample);
+  if (payload_bytes == nullptr) {
+    return;
+  }
+
+  std::array<uint8_t, sizeof(GroupAck)> frame{};
+  size_t frame_size = 0;
+  GroupAck ack{};
+  if (!bytes_to_buffer(payload_bytes, frame.data(), frame.size(), frame_size) ||
+      !decode_group_ack(frame.data(), frame_size, ack)) {
+    spdlog::warn("Unrecognized GroupAck frame ({} bytes)", frame_size);
+    return;
+  }
+  self->group_ack.post(ack);
+}
+
 Px4Client::~Px4Client() {
   ok_.store(false);
   close_zenoh();
   spdlog::info("zenoh client exit");
 }
 
-void ImguiClient::TelemetryHistory::push(const ServerPayload &p, size_t max_points) {
-  x.push_back(p.pos[0]);
-  y.push_back(p.pos[1]);
-  z.push_back(p.pos[2]);
-  xy_trace.emplace_back(p.pos[0], p.pos[1]);
-
-  thrust.push_back(p.thrust_setpoint);
-  omega_x.push_back(p.omega_setpoint[0]);
-  omega_y.push_back(p.omega_setpoint[1]);
-  omega_z.push_back(p.omega_setpoint[2]);
-  omega_xy_trace.emplace_back(p.omega_setpoint[0], p.omega_setpoint[1]);
-
-  while (x.size() > max_points) {
-    x.pop_front();
-    y.pop_front();
-    z.pop_front();
-    xy_trace.pop_front();
-    thrust.pop_front();
-    omega_x.pop_front();
-    omega_y.pop_front();
-    omega_z.pop_front();
-    omega_xy_trace.pop_front();
+void ImguiClient::TelemetryHistory::push(const ServerSample &p, const int64_t epoch_ns,
+                                         const uint64_t wanted) {
+  const double arrival = static_cast<double>(p.arrival_ns - epoch_ns) * 1e-9;
+  // Position samples by when the server took them, not when they arrived,
+  // so dropped packets, rate changes and network jitter keep the axis honest.
+  const double stamp = clock.align(static_cast<double>(p.timestamp) * 1e-3, arrival);
+  TelemetryRing::Sample sample{};
+  for (const auto &info : kChannels) {
+    if ((wanted & channel_bit(info.id)) == 0) continue;
+    if (!raw.enabled(info.id)) {
+      raw.enable(info.id);
+      for (auto &level : levels) {
+        level.enable(info.id);
+      }
+    }
+    sample[static_cast<size_t>(info.id)] = info.read(p);
+  }
+  raw.push(stamp, arrival, sample);
+  for (auto &level : levels) {
+    level.push(stamp, sample);
+  }
+  if (stamp >= trail_due) {
+    if (!trail.enabled(ChannelId::POS_X)) {
+      trail.enable(ChannelId::POS_X);
+      trail.enable(ChannelId::POS_Y);
+      trail.enable(ChannelId::POS_Z);
+    }
+    TelemetryRing::Sample pos{};
+    pos[static_cast<size_t>(ChannelId::POS_X)] = p.pos[0];
+    pos[static_cast<size_t>(ChannelId::POS_Y)] = p.pos[1];
+    pos[static_cast<size_t>(ChannelId::POS_Z)] = p.pos[2];
+    trail.push(stamp, arrival, pos);
+    trail_due = stamp + 1.0 / kTrailHz;
+  }
+  ++version;
+}
+
+void ImguiClient::TelemetryHistory::sync_from(const TelemetryHistory &src) {
+  raw.sync_from(src.raw);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    levels[i].sync_from(src.levels[i]);
   }
+  trail.sync_from(src.trail);
+  version = src.version;
 }
 
 ImguiClient::ImguiClient(Px4Client &px4_client) : px4_client_(px4_client) {
@@ -388,19 +756,46 @@ ImguiClient::ImguiClient(Px4Client &px4_client) : px4_client_(px4_client) {
   keyboard_vel_xy_ = std::max(0.0F, transport.keyboard_vel_xy);
   keyboard_vel_z_ = std::max(0.0F, transport.keyboard_vel_z);
   keyboard_vel_yaw_ = std::max(0.0F, transport.keyboard_vel_yaw);
-
-  log_observer_ = px4_client_.log_data.observe([&](const Px4Client::LogEntry &data) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    log_data_.push_back(data);
-    while (log_data_.size() > 2000) {
-      log_data_.pop_front();
-    }
-  });
-
-  server_observer_ = px4_client_.server_data.observe([&](const ServerPayload &data) {
+  gamepad_enabled_ = transport.gamepad_enabled;
+  gamepad_deadzone_ = std::clamp(transport.gamepad_deadzone, 0.0F, 0.9F);
+  gamepad_expo_ = std::clamp(transport.gamepad_expo, 0.0F, 1.0F);
+  redraw_.set_limits(transport.ui_max_fps, transport.ui_min_fps);
+  // Distinct from the ids of a previous run, which the server may still hold.
+  next_upload_id_ = static_cast<uint32_t>(to_uint64(clock::now())) | 1U;
+  next_group_seq_ = next_upload_id_;
+
+  // Both consumers run on the observer pool so the zenoh thread never waits
+  // on data_mutex_. Logs must not be lost; history may shed load instead.
+  log_observer_ = px4_client_.log_data.observe(
+      [&](const Px4Client::LogEntry &data) {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        log_data_.push_back(data);
+        while (log_data_.size() > 2000) {
+          log_data_.pop_front();
+        }
+        redraw_.notify();
+      },
+      {"logs", DispatchPolicy::BLOCK, 256});
+
+  // Each drone records history on its own keyed observer, subscribed here
+  // when the drone first reports: a burst from one drone only sheds that
+  // drone's samples, and drones record in parallel without data_mutex_. The
+  // discovering sample itself is not recorded.
+  server_observer_ = px4_client_.server_data.observe([&](const ServerSample &data) {
     std::lock_guard<std::mutex> lock(data_mutex_);
     server_data_map_[data.id] = data;
-    history_map_[data.id].push(data, 1200);
+    if (history_observers_.find(data.id) == history_observers_.end()) {
+      auto *history = &history_map_[data.id];
+      history_observers_[data.id] = px4_client_.server_data.observe(
+          data.id,
+          [this, history](const ServerSample &sample) {
+            history->live().push(sample, history_epoch_ns_,
+                                 wanted_channels_.load(std::memory_order_relaxed));
+            history->publish();
+            redraw_.notify(sample.arrival_ns);
+          },
+          {"history/" + std::to_string(data.id), DispatchPolicy::DROP_OLDEST, 1024});
+    }
     if (hover_input_map_.find(data.id) == hover_input_map_.end()) {
       hover_input_map_[data.id] = {data.pos[0], data.pos[1], data.pos[2],
                                     static_cast<float>(to_yaw({data.quat[0], data.quat[1],
@@ -420,29 +815,85 @@ ImguiClient::ImguiClient(Px4Client &px4_client) : px4_client_(px4_client) {
       safety.enable_attitude_fence = data.enable_attitude_fence != 0;
       safety.initialized_from_telemetry = true;
     }
-  });
-}
+    redraw_.notify(data.arrival_ns);
+  }, {"drones", DispatchPolicy::DROP_OLDEST, 4096});
 
-bool ImguiClient::valid_limit(float limit) {
-  return limit == -1.0F || (limit > 0.0F && limit <= 180.0F);
-}
+  trajectory_ack_observer_ = px4_client_.trajectory_ack.observe(
+      [&](const TrajectoryAck &ack) {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        const auto it = trajectory_upload_map_.find(ack.id);
+        if (it == trajectory_upload_map_.end()) return;
+        auto &upload = it->second;
+        if (upload.upload_id != ack.upload_id ||
+            upload.phase != TrajectoryUploadState::Phase::SENDING) {
+          return;
+        }
+        const auto now = clock::now();
+        upload.last_activity = now;
+        upload.next_seq = std::clamp(ack.next_seq, upload.next_seq,
+                                     static_cast<uint16_t>(upload.chunks->size()));
+        if (ack.status == TrajectoryAckStatus::COMPLETE) {
+          upload.phase = TrajectoryUploadState::Phase::COMPLETE;
+          upload.next_seq = static_cast<uint16_t>(upload.chunks->size());
+          upload.complete_ms = elapsed_ms(upload.started_at, now);
+        } else if (ack.status == TrajectoryAckStatus::REJECTED) {
+          upload.phase = TrajectoryUploadState::Phase::REJECTED;
+        }
+        redraw_.notify();
+      },
+      {"traj_ack", DispatchPolicy::BLOCK, 64});
 
-void ImguiClient::trim_deque(std::deque<float> &q, size_t max_points) {
-  while (q.size() > max_points) {
-    q.pop_front();
-  }
+  // A group command is answered by every member at about the same time.
+  group_ack_observer_ = px4_client_.group_ack.observe(
+      [&](const GroupAck &ack) {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        const auto it = std::find_if(
+            group_commands_.begin(), group_commands_.end(),
+            [&](const GroupCommandState &command) { return command.header.seq == ack.seq; });
+        if (it == group_commands_.end()) return;
+        auto &command = *it;
+        const bool member =
+            std::any_of(command.members.begin(), command.members.end(),
+                        [&](const GroupMember &m) { return m.id == ack.id; });
+        if (!member || command.ack_ms.count(ack.id) != 0) return;
+        const double ms = elapsed_ms(command.clicked_at, clock::now());
+        command.ack_ms[ack.id] = ms;
+        if (ack.status == GroupAckStatus::REJECTED) command.rejected.insert(ack.id);
+        if (command.ack_ms.size() == command.members.size()) command.all_acked_ms = ms;
+        redraw_.notify();
+      },
+      {"group_ack", DispatchPolicy::BLOCK, 1024});
+
+  // Input older than a few control periods (never less than a few frames at
+  // ui_max_fps) is stale; set before the loop thread reads it.
+  double max_age_sec =
+      kMaxInputAgePeriods / std::max(static_cast<double>(transport.control_hz), 1.0);
+  if (transport.ui_max_fps > 0.0F) {
+    max_age_sec = std::max(max_age_sec, 3.0 / transport.ui_max_fps);
+  }
+  max_input_age_ns_ = static_cast<int64_t>(max_age_sec * 1e9);
+
+  // Hover-target integration and CHANGE_HOVER_POS run at a fixed rate,
+  // whatever the UI frame rate.
+  control_loop_ = std::make_unique<FixedRateLoop>(
+      transport.control_hz, [this](double dt) { control_tick(dt); });
 }
 
-void ImguiClient::trim_deque(std::deque<ImVec2> &q, size_t max_points) {
-  while (q.size() > max_points) {
-    q.pop_front();
-  }
+bool ImguiClient::valid_limit(float limit) {
+  return limit == -1.0F || (limit > 0.0F && limit <= 180.0F);
 }
 
-void ImguiClient::render_line_plot(const char *label, const std::deque<float> &series,
-                                   ImVec2 size, float sample_hz, float min_v,
-                                   float max_v, ImU32 line_color) {
+void ImguiClient::render_line_plot(const char *label, const uint8_t id,
+                                   const TelemetryRing &ring, const ChannelId channel,
+                                   const double t_begin, const double t_end,
+                                   const uint64_t version, PlotGeometryCache &cache,
+                                   ImVec2 size,
+                                   float min_v, float max_v, ImU32 line_color) {
   if (line_color == 0) line_color = IM_COL32(80, 220, 120, 255);
+  const size_t first = ring_lower_bound(ring.stamps(channel), t_begin, std::identity{});
+  const size_t count = ring.size(channel) - first;
+  const auto series = ring.channel(channel).subview(first, count);
+  const auto stamps = ring.stamps(channel).subview(first, count);
   if (series.empty()) {
     ImGui::Text("%s: no data", label);
     return;
@@ -450,105 +901,165 @@ void ImguiClient::render_line_plot(const char *label, const std::deque<float> &s
   ImGui::Text("%s", label);
   ImGui::BeginChild(label, size, true);
 
-  std::vector<float> values(series.begin(), series.end());
   if (min_v == FLT_MAX || max_v == FLT_MAX) {
-    const auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
-    min_v = *min_it;
-    max_v = *max_it;
-  }
-  if (std::abs(max_v - min_v) < 1e-6F) {
-    min_v -= 1.0F;
-    max_v += 1.0F;
+    // The ring's O(1) extrema only describe the plot when all of it is visible.
+    if (first == 0) {
+      min_v = ring.min(channel);
+      max_v = ring.max(channel);
+    } else {
+      view_extrema(series, min_v, max_v);
+    }
   }
 
-  ImDrawList *draw = ImGui::GetWindowDrawList();
+  ImDrawList *window_draw = ImGui::GetWindowDrawList();
   const ImVec2 origin = ImGui::GetCursorScreenPos();
   const ImVec2 avail = ImGui::GetContentRegionAvail();
-  const ImVec2 p0 = origin;
-  const ImVec2 p1 = ImVec2(origin.x + avail.x, origin.y + avail.y);
-
-  draw->AddRectFilled(p0, p1, IM_COL32(20, 20, 24, 255));
-  draw->AddRect(p0, p1, IM_COL32(80, 80, 80, 255));
-
-  const float pad_l = 42.0F;
-  const float pad_r = 10.0F;
-  const float pad_t = 8.0F;
-  const float pad_b = 18.0F;
-  const float plot_w = std::max(1.0F, avail.x - pad_l - pad_r);
-  const float plot_h = std::max(1.0F, avail.y - pad_t - pad_b);
-
-  auto to_screen = [&](const int idx, const float v) {
-    const float tx = (values.size() <= 1)
-                         ? 1.0F
-                         : static_cast<float>(idx) /
-                               static_cast<float>(values.size() - 1);
-    const float ty = (v - min_v) / (max_v - min_v);
-    return ImVec2(p0.x + pad_l + tx * plot_w,
-                  p1.y - pad_b - ty * plot_h);
+  const PlotGeometryCache::Params params{min_v, max_v,
+                                         PlotGeometryCache::color_param(line_color),
+                                         static_cast<float>(t_end - t_begin)};
+
+  // Hover readout of the nearest sample, located by binary search on time.
+  auto hover_readout = [&]() {
+    if (!ImGui::IsWindowHovered()) return;
+    const float plot_w =
+        std::max(1.0F, avail.x - TimePlotFrame::kPadL - TimePlotFrame::kPadR);
+    const float u = std::clamp(
+        (ImGui::GetMousePos().x - origin.x - TimePlotFrame::kPadL) / plot_w, 0.0F, 1.0F);
+    const double t = t_begin + u * (t_end - t_begin);
+    size_t i = std::min(ring_lower_bound(stamps, t, std::identity{}), stamps.size() - 1);
+    if (i > 0 && t - stamps[i - 1] < stamps[i] - t) --i;
+    const double late_ms = (ring.arrivals(channel).subview(first, count)[i] - stamps[i]) * 1e3;
+    ImGui::SetTooltip("%.3f at %.2fs\narrived %.0f ms after the fastest sample", series[i],
+                      stamps[i] - t_end, late_ms);
   };
 
-  sample_hz = std::max(1.0F, sample_hz);
-  const int kTickCount = (plot_h >= 130.0F) ? 4 : 3;
-  for (int i = 0; i <= kTickCount; ++i) {
-    const float t = static_cast<float>(i) / static_cast<float>(kTickCount);
-    const float x = p0.x + pad_l + t * plot_w;
-    const float y = p1.y - pad_b - t * plot_h;
+  // On the GPU path the cache holds only the frame, which does not change
+  // with the data; the samples are already in vertex buffers.
+  const bool gpu = gl_lines_.ready();
+  const bool replayed =
+      cache.replay(window_draw, gpu ? 0 : version, origin, avail, params);
+  if (replayed && !gpu) {
+    hover_readout();
+    ImGui::EndChild();
+    return;
+  }
+  if (!replayed) cache.begin(window_draw, gpu ? 0 : version, origin, avail, params);
+
+  const TimePlotFrame frame(t_begin, t_end, min_v, max_v, !replayed);
+  ImDrawList *draw = frame.draw;
+
+  if (gpu) {
+    if (!replayed) cache.end(draw);
+    GlLineRenderer::Style style;
+    style.rect_min = ImVec2(frame.p0.x + TimePlotFrame::kPadL,
+                            frame.p1.y - TimePlotFrame::kPadB - frame.plot_h);
+    style.rect_max = ImVec2(style.rect_min.x + frame.plot_w,
+                            frame.p1.y - TimePlotFrame::kPadB);
+    style.t_begin = frame.t_first;
+    style.t_span = frame.span;
+    style.min_v = frame.min_v;
+    style.max_v = frame.max_v;
+    style.color = line_color;
+    // One sample before the window so the line reaches the left edge.
+    gl_lines_.draw(draw, (uint32_t{id} << 8) | static_cast<uint32_t>(channel), ring,
+                   channel, first > 0 ? first - 1 : 0, style);
+  } else {
+    cache.points.clear();
+    m4_decimate(stamps, series, t_begin, t_end,
+                static_cast<size_t>(frame.plot_w), [&](const size_t i) {
+                  cache.points.push_back(frame.to_screen(stamps[i], series[i]));
+                });
+    if (cache.points.size() >= 2) {
+      draw->AddPolyline(cache.points.data(), static_cast<int>(cache.points.size()),
+                        line_color, ImDrawFlags_None, 1.5F);
+    }
+  }
+  draw->AddCircleFilled(frame.to_screen(stamps.back(), series.back()), 3.0F,
+                        IM_COL32(255, 180, 80, 255));
 
-    draw->AddLine(ImVec2(x, p0.y + pad_t), ImVec2(x, p1.y - pad_b),
-                  IM_COL32(55, 55, 65, 180), 1.0F);
-    draw->AddLine(ImVec2(p0.x + pad_l, y), ImVec2(p1.x - pad_r, y),
-                  IM_COL32(55, 55, 65, 180), 1.0F);
+  if (!gpu) cache.end(draw);
+  hover_readout();
+  ImGui::EndChild();
+}
 
-    const float y_val = min_v + t * (max_v - min_v);
-    char y_tick[24];
-    std::snprintf(y_tick, sizeof(y_tick), "%.2f", y_val);
-    draw->AddText(ImVec2(p0.x + 2.0F, y - 7.0F),
-                  IM_COL32(150, 150, 160, 220), y_tick);
+void ImguiClient::render_envelope_plot(const char *label, const PyramidLevel &level,
+                                       const ChannelId channel,
+                                       const double t_begin, const double t_end,
+                                       const uint64_t version, PlotGeometryCache &cache,
+                                       ImVec2 size, float min_v, float max_v,
+                                       ImU32 line_color) {
+  if (line_color == 0) line_color = IM_COL32(80, 220, 120, 255);
+  const size_t first = ring_lower_bound(level.ends(channel), t_begin, std::identity{});
+  const size_t count = level.size(channel) - first;
+  if (count == 0) {
+    ImGui::Text("%s: no data", label);
+    return;
+  }
+  const auto starts = level.starts(channel).subview(first, count);
+  const auto ends = level.ends(channel).subview(first, count);
+  const auto mins = level.min(channel).subview(first, count);
+  const auto maxs = level.max(channel).subview(first, count);
+  const auto means = level.mean(channel).subview(first, count);
+  ImGui::Text("%s", label);
+  ImGui::BeginChild(label, size, true);
 
-    const int n = static_cast<int>(values.size());
-    const int sample_idx = (n <= 1) ? 0 : static_cast<int>(std::round(t * (n - 1)));
-    const int samples_ago = std::max(0, n - 1 - sample_idx);
-    const float sec_ago = static_cast<float>(samples_ago) / sample_hz;
-    char x_tick[24];
-    if (samples_ago == 0 || sec_ago < 0.05F) {
-      std::snprintf(x_tick, sizeof(x_tick), "0s");
-    } else if (sec_ago >= 10.0F) {
-      std::snprintf(x_tick, sizeof(x_tick), "-%.0fs", sec_ago);
-    } else {
-      std::snprintf(x_tick, sizeof(x_tick), "-%.1fs", sec_ago);
+  if (min_v == FLT_MAX || max_v == FLT_MAX) {
+    min_v = mins.front();
+    max_v = maxs.front();
+    for (size_t i = 0; i < count; ++i) {
+      min_v = std::min(min_v, mins[i]);
+      max_v = std::max(max_v, maxs[i]);
     }
-    draw->AddText(ImVec2(x - 12.0F, p1.y - pad_b + 2.0F),
-                  IM_COL32(150, 150, 160, 220), x_tick);
   }
 
-  if (min_v < 0.0F && max_v > 0.0F) {
-    const float t0 = static_cast<float>((0.0 - min_v) / (max_v - min_v));
-    const float y0 = p1.y - pad_b - t0 * plot_h;
-    draw->AddLine(ImVec2(p0.x + pad_l, y0), ImVec2(p1.x - pad_r, y0),
-                  IM_COL32(110, 110, 135, 220), 1.4F);
+  ImDrawList *window_draw = ImGui::GetWindowDrawList();
+  const ImVec2 origin = ImGui::GetCursorScreenPos();
+  const ImVec2 avail = ImGui::GetContentRegionAvail();
+  const PlotGeometryCache::Params params{
+      min_v, max_v, PlotGeometryCache::color_param(line_color),
+      static_cast<float>(t_end - t_begin), static_cast<float>(level.factor())};
+  if (cache.replay(window_draw, version, origin, avail, params)) {
+    ImGui::EndChild();
+    return;
   }
+  cache.begin(window_draw, version, origin, avail, params);
 
-  if (values.size() >= 2) {
-    ImVec2 last = to_screen(0, values[0]);
-    for (int i = 1; i < static_cast<int>(values.size()); ++i) {
-      const ImVec2 cur = to_screen(i, values[i]);
-      draw->AddLine(last, cur, line_color, 1.5F);
-      last = cur;
-    }
-    draw->AddCircleFilled(to_screen(static_cast<int>(values.size() - 1), values.back()),
-                          3.0F, IM_COL32(255, 180, 80, 255));
-  } else {
-    draw->AddCircleFilled(to_screen(0, values[0]), 3.0F,
-                          IM_COL32(255, 180, 80, 255));
+  const TimePlotFrame frame(t_begin, t_end, min_v, max_v);
+  ImDrawList *draw = frame.draw;
+  const ImU32 fill_color = (line_color & ~IM_COL32_A_MASK) | IM_COL32(0, 0, 0, 70);
+
+  // Each bucket is drawn as a min..max band so short spikes stay visible,
+  // with the mean as the trace through it.
+  cache.points.clear();
+  for (size_t i = 0; i < count; ++i) {
+    const ImVec2 lo = frame.to_screen(std::max(starts[i], t_begin), mins[i]);
+    const ImVec2 hi = frame.to_screen(ends[i], maxs[i]);
+    draw->AddRectFilled(ImVec2(lo.x, hi.y), ImVec2(std::max(hi.x, lo.x + 1.0F), lo.y),
+                        fill_color);
+    cache.points.push_back(frame.to_screen(0.5 * (starts[i] + ends[i]), means[i]));
+  }
+  if (cache.points.size() >= 2) {
+    draw->AddPolyline(cache.points.data(), static_cast<int>(cache.points.size()),
+                      line_color, ImDrawFlags_None, 1.5F);
   }
 
+  cache.end(draw);
   ImGui::EndChild();
 }
 
-void ImguiClient::render_xy_plot(const char *label, const std::deque<ImVec2> &series,
-                                 ImVec2 size, const float *geofence_min,
-                                 const float *geofence_max,
+void ImguiClient::render_xy_plot(const char *label, const TelemetryRing &ring,
+                                 const double t_begin, const uint64_t version,
+                                 PlotGeometryCache &cache, ImVec2 size,
+                                 const float *geofence_min, const float *geofence_max,
                                  const bool geofence_enabled) {
+  // Both columns are enabled together, so they are index-aligned. Only the
+  // plot span is drawn, like the time plots.
+  const size_t first =
+      ring_lower_bound(ring.stamps(ChannelId::POS_X), t_begin, std::identity{});
+  const auto all_xs = ring.channel(ChannelId::POS_X);
+  const auto all_ys = ring.channel(ChannelId::POS_Y).subview(0, all_xs.size());
+  const auto xs = all_xs.subview(first, all_xs.size() - first);
+  const auto ys = all_ys.subview(first, xs.size());
   ImGui::Text("%s", label);
   ImGui::BeginChild(label, size, true);
 
@@ -558,28 +1069,33 @@ void ImguiClient::render_xy_plot(const char *label, const std::deque<ImVec2> &se
   const ImVec2 p0 = origin;
   const ImVec2 p1 = ImVec2(origin.x + avail.x, origin.y + avail.y);
 
-  draw->AddRectFilled(p0, p1, IM_COL32(20, 20, 24, 255));
-  draw->AddRect(p0, p1, IM_COL32(80, 80, 80, 255));
-
   const bool geofence_valid =
       geofence_min != nullptr && geofence_max != nullptr &&
       geofence_min[0] <= geofence_max[0] && geofence_min[1] <= geofence_max[1];
 
+  PlotGeometryCache::Params params{};
+  if (geofence_valid) {
+    params = {geofence_min[0], geofence_min[1], geofence_max[0], geofence_max[1],
+              geofence_enabled ? 1.0F : 0.0F, 1.0F};
+  }
+  params[6] = static_cast<float>(first); // span changes without new data
+
+  if (cache.replay(draw, version, origin, avail, params)) {
+    ImGui::EndChild();
+    return;
+  }
+  cache.begin(draw, version, origin, avail, params);
+
+  draw->AddRectFilled(p0, p1, IM_COL32(20, 20, 24, 255));
+  draw->AddRect(p0, p1, IM_COL32(80, 80, 80, 255));
+
   float min_x = -1.0F;
   float max_x = 1.0F;
   float min_y = -1.0F;
   float max_y = 1.0F;
-  if (!series.empty()) {
-    min_x = series.front().x;
-    max_x = series.front().x;
-    min_y = series.front().y;
-    max_y = series.front().y;
-    for (const auto &pt : series) {
-      min_x = std::min(min_x, pt.x);
-      max_x = std::max(max_x, pt.x);
-      min_y = std::min(min_y, pt.y);
-      max_y = std::max(max_y, pt.y);
-    }
+  if (!xs.empty()) {
+    view_extrema(xs, min_x, max_x);
+    view_extrema(ys, min_y, max_y);
   }
   if (geofence_valid) {
     min_x = std::min(min_x, geofence_min[0]);
@@ -679,21 +1195,22 @@ void ImguiClient::render_xy_plot(const char *label, const std::deque<ImVec2> &se
     draw->AddRect(rect_tl, rect_br, border_color, 0.0F, 0, 1.5F);
   }
 
-  if (series.size() >= 2) {
-    ImVec2 last = to_screen(series.front());
-    for (size_t i = 1; i < series.size(); ++i) {
-      const ImVec2 cur = to_screen(series[i]);
-      draw->AddLine(last, cur, IM_COL32(80, 220, 120, 255), 1.5F);
-      last = cur;
+  if (xs.size() >= 2) {
+    cache.points.clear();
+    for (size_t i = 0; i < xs.size(); ++i) {
+      cache.points.push_back(to_screen(ImVec2(xs[i], ys[i])));
     }
+    draw->AddPolyline(cache.points.data(), static_cast<int>(cache.points.size()),
+                      IM_COL32(80, 220, 120, 255), ImDrawFlags_None, 1.5F);
 
-    draw->AddCircleFilled(to_screen(series.back()), 3.0F,
+    draw->AddCircleFilled(to_screen(ImVec2(xs.back(), ys.back())), 3.0F,
                           IM_COL32(255, 120, 80, 255));
-  } else if (series.size() == 1) {
-    draw->AddCircleFilled(to_screen(series.front()), 3.0F,
+  } else if (xs.size() == 1) {
+    draw->AddCircleFilled(to_screen(ImVec2(xs.front(), ys.front())), 3.0F,
                           IM_COL32(255, 120, 80, 255));
   }
 
+  cache.end(draw);
   ImGui::EndChild();
 }
 
@@ -707,9 +1224,7 @@ void ImguiClient::render_header_bar(const ServerPayload &drone) {
 
   bool batt_valid = drone.battery_remaining > 0.0f;
   float batt_pct = drone.battery_remaining * 100.0f;
-  ImU32 batt_color = batt_pct > 40.0f ? IM_COL32(80, 220, 120, 255) :
-                     batt_pct > 15.0f ? IM_COL32(255, 210, 80, 255) :
-                                        IM_COL32(255, 80, 80, 255);
+  ImU32 batt_color = battery_color(batt_pct);
   if (batt_valid) {
     ImGui::TextColored(ImColor(batt_color), "Bat %.0f%% %.1fV", batt_pct, drone.battery_voltage);
   } else if (drone.battery_voltage > 0.1f) {
@@ -776,18 +1291,18 @@ void ImguiClient::render_status_panel(uint8_t id, const ServerPayload &drone) {
     if (drone.guard_flags == 0) {
       ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "none");
     } else {
-      std::string flags;
-      if (drone.guard_flags & 1) flags += "MAVROS ";
-      if (drone.guard_flags & 2) flags += "ODOM ";
-      if (drone.guard_flags & 4) flags += "UI ";
-      if (drone.guard_flags & 8) flags += "BATT ";
-      if (drone.guard_flags & 16) flags += "GEO ";
-      if (drone.guard_flags & 32) flags += "ATT ";
-      if (drone.guard_flags & 64) flags += "VEL ";
-      if (drone.guard_flags & 128) flags += "ODOM_HZ ";
-      if (drone.guard_flags & 256) flags += "RC_LOST ";
-      if (drone.guard_flags & 512) flags += "RC_REQ ";
-      ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%s", flags.c_str());
+      ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%s",
+                         guard_flags_text(drone.guard_flags).c_str());
+    }
+    ImGui::TableNextColumn(); ImGui::TextUnformatted("Telemetry:");
+    ImGui::TableNextColumn();
+    const auto rate_it = telemetry_rate_map_.find(id);
+    if (rate_it == telemetry_rate_map_.end() || rate_it->second.rate_hz < 0.0f) {
+      ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "---");
+    } else {
+      ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%.0f Hz  %s",
+                         rate_it->second.rate_hz,
+                         TelemetryTierName[static_cast<int>(rate_it->second.tier)]);
     }
     ImGui::EndTable();
   }
@@ -804,7 +1319,7 @@ void ImguiClient::render_command_panel(uint8_t id, const ServerPayload &drone) {
   if (ImGui::SmallButton(active ? "Stop" : "Start")) {
     if (active) { keyboard_listener_active_ = false; keyboard_target_id_ = -1; }
     else {
-      keyboard_listener_active_ = true; keyboard_target_id_ = id;
+      keyboard_listener_active_ = true; keyboard_target_id_ = id; focused_id_ = id;
       std::lock_guard<std::mutex> lock(data_mutex_);
       hover_input_map_.erase(id);
     }
@@ -815,6 +1330,10 @@ void ImguiClient::render_command_panel(uint8_t id, const ServerPayload &drone) {
   if (ImGui::SmallButton("Flip")) ctrl_in_world_ = !ctrl_in_world_;
 
   ImGui::TextDisabled("W/A/S/D XY  R/F Z  Q/E Yaw  Space Hover  J Disarm  L Land");
+  if (gamepad_enabled_ && gamepad_.connected) {
+    ImGui::TextDisabled("%s: left stick XY  right stick Z/Yaw  A Hover",
+                        gamepad_.name.c_str());
+  }
 
   // Row 1: Velocity inputs
   float fw = (ImGui::GetContentRegionAvail().x - 8.0f) / 3.0f;
@@ -842,18 +1361,26 @@ void ImguiClient::render_command_panel(uint8_t id, const ServerPayload &drone) {
   }
   float hfw = (ImGui::GetContentRegionAvail().x - 12.0f) / 5.0f;
   ImGui::PushItemWidth(hfw);
-  ImGui::InputFloat("##HX", &h[0], 0.0f, 0.0f, "X:%.1f"); ImGui::SameLine(0, 4.0f);
-  ImGui::InputFloat("##HY", &h[1], 0.0f, 0.0f, "Y:%.1f"); ImGui::SameLine(0, 4.0f);
-  ImGui::InputFloat("##HZ", &h[2], 0.0f, 0.0f, "Z:%.1f"); ImGui::SameLine(0, 4.0f);
-  ImGui::InputFloat("##HYaw", &h[3], 0.0f, 0.0f, "Y:%.1f");
+  std::array<bool, 4> edited{};
+  edited[0] = ImGui::InputFloat("##HX", &h[0], 0.0f, 0.0f, "X:%.1f"); ImGui::SameLine(0, 4.0f);
+  edited[1] = ImGui::InputFloat("##HY", &h[1], 0.0f, 0.0f, "Y:%.1f"); ImGui::SameLine(0, 4.0f);
+  edited[2] = ImGui::InputFloat("##HZ", &h[2], 0.0f, 0.0f, "Z:%.1f"); ImGui::SameLine(0, 4.0f);
+  edited[3] = ImGui::InputFloat("##HYaw", &h[3], 0.0f, 0.0f, "Y:%.1f");
   ImGui::PopItemWidth();
   ImGui::SameLine(0, 4.0f);
-  if (ImGui::SmallButton("Send")) {
-    send_hover_target(id, h);
-  }
-  {
+  const bool send = ImGui::SmallButton("Send");
+  // control_tick() may have moved the target since h was read, so only the
+  // fields edited this frame are written back, and Send takes the merge.
+  if (send || std::any_of(edited.begin(), edited.end(), [](bool e) { return e; })) {
     std::lock_guard<std::mutex> lock(data_mutex_);
-    hover_input_map_[id] = h;
+    auto &target = hover_input_map_[id];
+    for (size_t i = 0; i < target.size(); ++i) {
+      if (edited[i]) target[i] = h[i];
+    }
+    h = target;
+  }
+  if (send) {
+    send_hover_target(id, h);
   }
 
   // --- Commands ---
@@ -881,6 +1408,11 @@ void ImguiClient::render_command_panel(uint8_t id, const ServerPayload &drone) {
     disarm_confirm_target_id_ = static_cast<int>(id);
   }
 
+  if (ImGui::Button("TRAJECTORY...", ImVec2(ImGui::GetContentRegionAvail().x, 0))) {
+    ImGui::OpenPopup("Trajectory");
+  }
+  render_trajectory_popup(id, drone);
+
   // Confirmation popup
   if (show_disarm_confirm_ && disarm_confirm_target_id_ == static_cast<int>(id)) {
     ImGui::OpenPopup("Confirm Force Disarm");
@@ -938,109 +1470,200 @@ void ImguiClient::send_hover_target(uint8_t id, const std::array<float, 4> &hove
   px4_client_.pub_client(payload);
 }
 
-void ImguiClient::handle_keyboard_control() {
-  if (!keyboard_listener_active_ || keyboard_target_id_ < 0) {
-    return;
+TelemetryTier ImguiClient::telemetry_tier(uint8_t id, size_t drone_count) const {
+  if (!window_visible_) {
+    return TelemetryTier::BACKGROUND;
   }
-  const uint8_t target_id = static_cast<uint8_t>(keyboard_target_id_);
-  ServerPayload drone{};
-  std::array<float, 4> hover{};
-  {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    const auto drone_it = server_data_map_.find(target_id);
-    if (drone_it == server_data_map_.end()) {
-      keyboard_listener_active_ = false;
-      keyboard_target_id_ = -1;
-      return;
-    }
-    drone = drone_it->second;
+  if (drone_count == 1 || focused_id_ == static_cast<int>(id) ||
+      (keyboard_listener_active_ && keyboard_target_id_ == static_cast<int>(id))) {
+    return TelemetryTier::FOCUSED;
+  }
+  const auto it = section_visible_map_.find(id);
+  return (it != section_visible_map_.end() && it->second) ? TelemetryTier::VISIBLE
+                                                          : TelemetryTier::BACKGROUND;
+}
 
-    if (hover_input_map_.find(target_id) == hover_input_map_.end()) {
-      hover_input_map_[target_id] = {drone.pos[0], drone.pos[1], drone.pos[2],
-                                      static_cast<float>(to_yaw({drone.quat[0], drone.quat[1],
-                                                                 drone.quat[2], drone.quat[3]}))};
+void ImguiClient::update_telemetry_rates(
+    const std::vector<std::pair<uint8_t, ServerPayload>> &drones) {
+  const auto &paras = px4_client_.transport_paras();
+  const auto now = clock::now();
+  const float background_hz = std::max(1.0F, paras.telemetry_background_hz);
+  // Frames follow the data (see RedrawScheduler), so the measured frame rate
+  // would only chase the rate we ask for; cap by the configured limit instead.
+  const float max_fps = redraw_.max_fps();
+  const float ui_hz = max_fps > 0.0F ? max_fps : paras.telemetry_visible_hz;
+
+  for (const auto &[id, _] : drones) {
+    const TelemetryTier tier = telemetry_tier(id, drones.size());
+    float rate_hz = background_hz;
+    if (tier == TelemetryTier::FOCUSED) {
+      rate_hz = paras.telemetry_focused_hz;
+    } else if (tier == TelemetryTier::VISIBLE) {
+      rate_hz = std::min(paras.telemetry_visible_hz, ui_hz);
+    }
+    rate_hz = std::max(background_hz, std::round(rate_hz));
+
+    auto &state = telemetry_rate_map_[id];
+    const double since_ms = timeDuration(state.sent_at, now);
+    const bool changed = rate_hz != state.rate_hz || tier != state.tier;
+    if (!(changed && since_ms >= rate_min_interval_ms_) &&
+        since_ms < rate_refresh_interval_ms_) {
+      continue;
     }
-    hover = hover_input_map_[target_id];
+
+    ClientPayload payload{};
+    payload.id = id;
+    payload.command = ClientCommand::SET_TELEMETRY_RATE;
+    payload.timestamp = to_uint64(now);
+    TelemetryRatePayload rate{};
+    rate.rate_hz = rate_hz;
+    rate.tier = tier;
+    std::memcpy(payload.data, &rate, sizeof(rate));
+    px4_client_.pub_client(payload);
+
+    state.tier = tier;
+    state.rate_hz = rate_hz;
+    state.sent_at = now;
   }
+}
 
+void ImguiClient::handle_keyboard_control() {
+  // Held keys become axes for the control loop; only edge-triggered keys
+  // act here.
+  ControlInput &input = control_input_.live();
+  const auto prev_axes = input.axes;
+  const auto prev_buttons = pad_buttons_;
+  pad_buttons_ = gamepad_.buttons;
+  input.target = -1;
+  input.axes = {};
+  input.vel = {keyboard_vel_xy_, keyboard_vel_z_, keyboard_vel_yaw_};
+  input.sampled_ns = steady_ns();
+  ++input.version;
+
+  if (keyboard_listener_active_ && keyboard_target_id_ >= 0) {
+    bool known = false;
+    {
+      std::lock_guard<std::mutex> lock(data_mutex_);
+      known = server_data_map_.count(static_cast<uint8_t>(keyboard_target_id_)) != 0;
+    }
+    if (!known) {
+      keyboard_listener_active_ = false;
+      keyboard_target_id_ = -1;
+    }
+  }
   ImGuiIO &io = ImGui::GetIO();
-  if (io.WantTextInput) {
+  const bool flying = keyboard_listener_active_ && keyboard_target_id_ >= 0;
+  const bool pad = flying && gamepad_enabled_ && gamepad_.connected;
+  // While the sticks fly a drone they must not also navigate the UI.
+  if (pad && (io.ConfigFlags & ImGuiConfigFlags_NavEnableGamepad)) {
+    io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableGamepad;
+    pad_nav_suspended_ = true;
+  } else if (!pad && pad_nav_suspended_) {
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+    pad_nav_suspended_ = false;
+  }
+  if (!flying || io.WantTextInput) {
+    input.world = ctrl_in_world_;
+    if (input.axes != prev_axes) input.changed_ns = steady_ns();
+    control_input_.publish();
     return;
   }
+  const uint8_t target_id = static_cast<uint8_t>(keyboard_target_id_);
   if (ImGui::IsKeyPressed(ImGuiKey_C)) {
     ctrl_in_world_ = !ctrl_in_world_;
   }
 
-  const double dt = io.DeltaTime;
-  if (dt <= 0.0) {
-    return;
+  auto axis = [](ImGuiKey positive, ImGuiKey negative) {
+    return (ImGui::IsKeyDown(positive) ? 1.0F : 0.0F) - (ImGui::IsKeyDown(negative) ? 1.0F : 0.0F);
+  };
+  input.target = target_id;
+  input.world = ctrl_in_world_;
+  input.axes = {axis(ImGuiKey_W, ImGuiKey_S), axis(ImGuiKey_A, ImGuiKey_D),
+                axis(ImGuiKey_R, ImGuiKey_F), axis(ImGuiKey_Q, ImGuiKey_E)};
+  if (pad) {
+    // GLFW stick +y points down and +x right; commands are forward, left,
+    // up and counter-clockwise.
+    auto stick = [&](size_t axis_idx) {
+      return -shape_axis(gamepad_.axes[axis_idx], gamepad_deadzone_, gamepad_expo_);
+    };
+    const std::array<float, 4> sticks = {stick(kPadLeftY), stick(kPadLeftX), stick(kPadRightY),
+                                         stick(kPadRightX)};
+    for (size_t i = 0; i < input.axes.size(); ++i) {
+      input.axes[i] = std::clamp(input.axes[i] + sticks[i], -1.0F, 1.0F);
+    }
   }
+  // Sticks raise no window events and held keys only slow repeats, and the
+  // control loop drops samples older than kMaxInputAgePeriods, so keep
+  // sampling at the control rate.
+  if (pad || !input.idle()) {
+    redraw_.request_by(RedrawScheduler::steady::now() +
+                       std::chrono::duration_cast<RedrawScheduler::steady::duration>(
+                           std::chrono::duration<double>(control_loop_->period_sec())));
+  }
+  if (input.axes != prev_axes) input.changed_ns = steady_ns();
+  control_input_.publish();
 
-  const std::array<double, 3> vel_body_x = {keyboard_vel_xy_, 0.0, 0.0};
-  const std::array<double, 3> vel_body_y = {0.0, keyboard_vel_xy_, 0.0};
-  const std::array<double, 4> quat = {drone.quat[0], drone.quat[1], drone.quat[2],
-                                      drone.quat[3]};
-
-  std::array<double, 3> vel_world_x = vel_body_x;
-  std::array<double, 3> vel_world_y = vel_body_y;
-  if (!ctrl_in_world_) {
-    vel_world_x = q_rot(quat, vel_body_x);
-    vel_world_y = q_rot(quat, vel_body_y);
+  if (pad && pad_buttons_[kPadButtonA] != 0 && prev_buttons[kPadButtonA] == 0) {
+    send_simple_command(target_id, ClientCommand::FORCE_HOVER);
   }
 
-  bool hover_changed = false;
-  if (ImGui::IsKeyDown(ImGuiKey_W)) {
-    hover[0] += static_cast<float>(vel_world_x[0] * dt);
-    hover[1] += static_cast<float>(vel_world_x[1] * dt);
-    hover_changed = true;
+  if (ImGui::IsKeyPressed(ImGuiKey_Space)) {
+    send_simple_command(target_id, ClientCommand::FORCE_HOVER);
   }
-  if (ImGui::IsKeyDown(ImGuiKey_S)) {
-    hover[0] -= static_cast<float>(vel_world_x[0] * dt);
-    hover[1] -= static_cast<float>(vel_world_x[1] * dt);
-    hover_changed = true;
-  }
-  if (ImGui::IsKeyDown(ImGuiKey_A)) {
-    hover[0] += static_cast<float>(vel_world_y[0] * dt);
-    hover[1] += static_cast<float>(vel_world_y[1] * dt);
-    hover_changed = true;
-  }
-  if (ImGui::IsKeyDown(ImGuiKey_D)) {
-    hover[0] -= static_cast<float>(vel_world_y[0] * dt);
-    hover[1] -= static_cast<float>(vel_world_y[1] * dt);
-    hover_changed = true;
-  }
-  if (ImGui::IsKeyDown(ImGuiKey_R)) {
-    hover[2] += static_cast<float>(keyboard_vel_z_ * dt);
-    hover_changed = true;
+  if (ImGui::IsKeyPressed(ImGuiKey_J)) {
+    send_simple_command(target_id, ClientCommand::FORCE_DISARM);
   }
-  if (ImGui::IsKeyDown(ImGuiKey_F)) {
-    hover[2] -= static_cast<float>(keyboard_vel_z_ * dt);
-    hover_changed = true;
+  if (ImGui::IsKeyPressed(ImGuiKey_L)) {
+    send_simple_command(target_id, ClientCommand::LAND);
   }
-  if (ImGui::IsKeyDown(ImGuiKey_Q)) {
-    hover[3] += static_cast<float>(keyboard_vel_yaw_ * dt);
-    hover_changed = true;
+}
+
+void ImguiClient::control_tick(const double dt) {
+  const ControlInput &input = control_input_.snapshot();
+  if (input.target < 0 || input.idle()) {
+    return;
   }
-  if (ImGui::IsKeyDown(ImGuiKey_E)) {
-    hover[3] -= static_cast<float>(keyboard_vel_yaw_ * dt);
-    hover_changed = true;
+  // A UI thread that stopped sampling (stalled frame, hidden window) must not
+  // keep the drone moving on the last held axes.
+  if (steady_ns() - input.sampled_ns > max_input_age_ns_) {
+    return;
   }
-  if (hover_changed) {
-    {
-      std::lock_guard<std::mutex> lock(data_mutex_);
-      hover_input_map_[target_id] = hover;
+  const auto target_id = static_cast<uint8_t>(input.target);
+  std::array<float, 4> hover{};
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    const auto drone_it = server_data_map_.find(target_id);
+    if (drone_it == server_data_map_.end()) {
+      return;
+    }
+    const ServerPayload &drone = drone_it->second;
+    auto hover_it = hover_input_map_.find(target_id);
+    if (hover_it == hover_input_map_.end()) {
+      hover_it = hover_input_map_
+                     .emplace(target_id,
+                              std::array<float, 4>{
+                                  drone.pos[0], drone.pos[1], drone.pos[2],
+                                  static_cast<float>(to_yaw({drone.quat[0], drone.quat[1],
+                                                             drone.quat[2], drone.quat[3]}))})
+                     .first;
     }
-    send_hover_target(target_id, hover);
-  }
 
-  if (ImGui::IsKeyPressed(ImGuiKey_Space)) {
-    send_simple_command(target_id, ClientCommand::FORCE_HOVER);
-  }
-  if (ImGui::IsKeyPressed(ImGuiKey_J)) {
-    send_simple_command(target_id, ClientCommand::FORCE_DISARM);
-  }
-  if (ImGui::IsKeyPressed(ImGuiKey_L)) {
-    send_simple_command(target_id, ClientCommand::LAND);
+    std::array<double, 3> vel = {input.axes[0] * input.vel[0], input.axes[1] * input.vel[0],
+                                 0.0};
+    if (!input.world) {
+      vel = q_rot({drone.quat[0], drone.quat[1], drone.quat[2], drone.quat[3]}, vel);
+    }
+    hover = hover_it->second;
+    hover[0] += static_cast<float>(vel[0] * dt);
+    hover[1] += static_cast<float>(vel[1] * dt);
+    hover[2] += static_cast<float>(input.axes[2] * input.vel[1] * dt);
+    hover[3] += static_cast<float>(input.axes[3] * input.vel[2] * dt);
+    hover_it->second = hover;
+  }
+  send_hover_target(target_id, hover);
+  if (input.changed_ns != published_change_ns_) {
+    published_change_ns_ = input.changed_ns;
+    input_latency_.add(static_cast<double>(steady_ns() - input.changed_ns) / 1e6);
   }
 }
 
@@ -1126,57 +1749,792 @@ void ImguiClient::render_safety_popup(uint8_t id) {
   }
 }
 
+void ImguiClient::render_trajectory_popup(uint8_t id, const ServerPayload &drone) {
+  ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetCenter(), ImGuiCond_Appearing,
+                          ImVec2(0.5f, 0.5f));
+  if (!ImGui::BeginPopupModal("Trajectory", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+    return;
+  }
+  auto &path = path_editor_map_[id];
+  const float yaw = static_cast<float>(
+      to_yaw({drone.quat[0], drone.quat[1], drone.quat[2], drone.quat[3]}));
+  if (!path.centered) {
+    path.center = {drone.pos[0], drone.pos[1]};
+    path.altitude = std::max(drone.pos[2], 1.0F);
+    path.centered = true;
+  }
+
+  ImGui::Text("Drone %d at (%.1f, %.1f, %.1f)", id, drone.pos[0], drone.pos[1], drone.pos[2]);
+  ImGui::TextDisabled("Left click adds a waypoint, right click removes the last, wheel zooms.");
+
+  // --- Canvas: top-down XY, x right, y up like the XY plot ---
+  constexpr float kCanvas = 360.0f;
+  ImGui::InvisibleButton("##PathCanvas", ImVec2(kCanvas, kCanvas),
+                         ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight);
+  const ImVec2 p0 = ImGui::GetItemRectMin();
+  const ImVec2 p1(p0.x + kCanvas, p0.y + kCanvas);
+  const ImVec2 mid(p0.x + kCanvas * 0.5f, p0.y + kCanvas * 0.5f);
+  const float scale = kCanvas / (2.0f * path.extent); // px per m
+  auto to_screen = [&](float x, float y) {
+    return ImVec2(mid.x + (x - path.center[0]) * scale, mid.y - (y - path.center[1]) * scale);
+  };
+  if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+    const ImVec2 m = ImGui::GetIO().MousePos;
+    TrajectoryPoint point{};
+    point.pos[0] = path.center[0] + (m.x - mid.x) / scale;
+    point.pos[1] = path.center[1] - (m.y - mid.y) / scale;
+    point.pos[2] = path.altitude;
+    point.yaw = yaw;
+    path.points.push_back(point);
+    time_trajectory(path.points, path.speed);
+  }
+  if (ImGui::IsItemClicked(ImGuiMouseButton_Right) && !path.points.empty()) {
+    path.points.pop_back();
+  }
+  if (ImGui::IsItemHovered() && ImGui::GetIO().MouseWheel != 0.0f) {
+    path.extent = std::clamp(path.extent * std::pow(0.85f, ImGui::GetIO().MouseWheel), 1.0f,
+                             500.0f);
+  }
+
+  ImDrawList *draw = ImGui::GetWindowDrawList();
+  draw->AddRectFilled(p0, p1, IM_COL32(22, 24, 30, 255), 4.0f);
+  draw->PushClipRect(p0, p1, true);
+  // Grid on a 1-2-5 step giving at most ~10 lines across.
+  float step = 1.0f;
+  for (int i = 0; 2.0f * path.extent / step > 10.0f; ++i) {
+    step *= (i % 3 == 1) ? 2.5f : 2.0f;
+  }
+  const float gx0 = std::floor((path.center[0] - path.extent) / step) * step;
+  const float gy0 = std::floor((path.center[1] - path.extent) / step) * step;
+  for (float g = gx0; g <= path.center[0] + path.extent; g += step) {
+    const float x = to_screen(g, 0.0f).x;
+    draw->AddLine(ImVec2(x, p0.y), ImVec2(x, p1.y),
+                  g == 0.0f ? IM_COL32(110, 110, 135, 220) : IM_COL32(55, 55, 65, 180));
+  }
+  for (float g = gy0; g <= path.center[1] + path.extent; g += step) {
+    const float y = to_screen(0.0f, g).y;
+    draw->AddLine(ImVec2(p0.x, y), ImVec2(p1.x, y),
+                  g == 0.0f ? IM_COL32(110, 110, 135, 220) : IM_COL32(55, 55, 65, 180));
+  }
+  if (drone.enable_geofence != 0) {
+    const ImVec2 a = to_screen(drone.geofence_min[0], drone.geofence_max[1]);
+    const ImVec2 b = to_screen(drone.geofence_max[0], drone.geofence_min[1]);
+    draw->AddRect(a, b, IM_COL32(239, 68, 68, 200), 0.0f, 0, 1.5f);
+  }
+  if (!path.points.empty()) {
+    std::vector<ImVec2> screen;
+    screen.reserve(path.points.size() + 1);
+    screen.push_back(to_screen(drone.pos[0], drone.pos[1]));
+    for (const auto &point : path.points) {
+      screen.push_back(to_screen(point.pos[0], point.pos[1]));
+    }
+    draw->AddPolyline(screen.data(), static_cast<int>(screen.size()),
+                      IM_COL32(80, 180, 255, 220), ImDrawFlags_None, 1.5f);
+    if (path.points.size() <= 200) {
+      for (size_t i = 1; i < screen.size(); ++i) {
+        draw->AddCircleFilled(screen[i], 3.0f, IM_COL32(80, 180, 255, 255));
+      }
+    }
+  }
+  const ImVec2 at = to_screen(drone.pos[0], drone.pos[1]);
+  draw->AddCircleFilled(at, 5.0f, drone_color(id));
+  draw->AddLine(at, ImVec2(at.x + 14.0f * std::cos(yaw), at.y - 14.0f * std::sin(yaw)),
+                drone_color(id), 2.0f);
+  draw->PopClipRect();
+  char scale_text[32];
+  std::snprintf(scale_text, sizeof(scale_text), "grid %.3g m", step);
+  draw->AddText(ImVec2(p0.x + 4.0f, p1.y - ImGui::GetTextLineHeight() - 2.0f),
+                IM_COL32(150, 150, 160, 220), scale_text);
+
+  // --- Path settings ---
+  ImGui::PushItemWidth(110.0f);
+  ImGui::DragFloat("##PathAlt", &path.altitude, 0.05f, 0.2f, 100.0f, "alt %.2f m");
+  ImGui::SameLine(0, 4.0f);
+  ImGui::DragFloat("##PathSpeed", &path.speed, 0.05f, 0.1f, 20.0f, "%.2f m/s");
+  ImGui::PopItemWidth();
+  ImGui::SameLine(0, 4.0f);
+  if (ImGui::SmallButton("Retime")) time_trajectory(path.points, path.speed);
+  ImGui::SameLine(0, 4.0f);
+  if (ImGui::SmallButton("Center")) path.center = {drone.pos[0], drone.pos[1]};
+
+  ImGui::SetNextItemWidth(kCanvas - 90.0f);
+  ImGui::InputTextWithHint("##PathCsv", "path.csv (x,y,z[,yaw] or t,x,y,z,yaw)", path.csv_path,
+                           sizeof(path.csv_path));
+  ImGui::SameLine(0, 4.0f);
+  if (ImGui::Button("Import", ImVec2(-FLT_MIN, 0))) {
+    path.csv_error.clear();
+    if (load_trajectory_csv(path.csv_path, path.speed, yaw, path.points, path.csv_error) &&
+        !path.points.empty()) {
+      path.center = {path.points.front().pos[0], path.points.front().pos[1]};
+    }
+  }
+  if (!path.csv_error.empty()) {
+    ImGui::TextColored(ImVec4(0.95f, 0.2f, 0.2f, 1.0f), "%s", path.csv_error.c_str());
+  }
+
+  float length = 0.0f;
+  for (size_t i = 1; i < path.points.size(); ++i) {
+    const float dx = path.points[i].pos[0] - path.points[i - 1].pos[0];
+    const float dy = path.points[i].pos[1] - path.points[i - 1].pos[1];
+    const float dz = path.points[i].pos[2] - path.points[i - 1].pos[2];
+    length += std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  const size_t messages =
+      (path.points.size() + kTrajectoryChunkPoints - 1) / kTrajectoryChunkPoints;
+  ImGui::Text("%zu waypoints, %.1f m, %.1f s, %zu message%s", path.points.size(), length,
+              path.points.empty() ? 0.0f : path.points.back().t, messages,
+              messages == 1 ? "" : "s");
+
+  // --- Upload ---
+  TrajectoryUploadState upload;
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    const auto it = trajectory_upload_map_.find(id);
+    if (it != trajectory_upload_map_.end()) upload = it->second;
+  }
+  const bool sending = upload.phase == TrajectoryUploadState::Phase::SENDING;
+  ImGui::Checkbox("Start when complete", &path.start_on_complete);
+  ImGui::BeginDisabled(path.points.empty() || sending);
+  ImGui::SameLine();
+  if (ImGui::Button("Upload")) upload_trajectory(id, path.points, path.start_on_complete);
+  ImGui::EndDisabled();
+  ImGui::SameLine();
+  if (ImGui::Button("Clear")) path.points.clear();
+  ImGui::SameLine();
+  if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
+
+  if (upload.phase != TrajectoryUploadState::Phase::IDLE) {
+    const size_t chunks = upload.chunks ? upload.chunks->size() : 0;
+    ImGui::Text("upload %08x: %s, %u/%zu chunks acked, %zu msgs sent, %d retries",
+                upload.upload_id, kUploadPhaseName[static_cast<int>(upload.phase)],
+                static_cast<unsigned>(upload.next_seq), chunks, upload.messages,
+                upload.retries);
+    if (upload.phase == TrajectoryUploadState::Phase::COMPLETE) {
+      ImGui::Text("%zu points acknowledged %.1f ms after the first chunk", upload.points,
+                  upload.complete_ms);
+    }
+  }
+  ImGui::EndPopup();
+}
+
+void ImguiClient::upload_trajectory(uint8_t id, const std::vector<TrajectoryPoint> &points,
+                                    bool start) {
+  const auto now = clock::now();
+  uint32_t upload_id = next_upload_id_++;
+  if (upload_id == 0) upload_id = next_upload_id_++;
+  auto chunks = std::make_shared<const std::vector<std::vector<uint8_t>>>(encode_trajectory(
+      id, upload_id, points, start ? TRAJECTORY_START_ON_COMPLETE : 0,
+      static_cast<uint64_t>(to_uint64(now))));
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto &upload = trajectory_upload_map_[id];
+    upload = TrajectoryUploadState{};
+    upload.phase = TrajectoryUploadState::Phase::SENDING;
+    upload.upload_id = upload_id;
+    upload.chunks = chunks;
+    upload.points = points.size();
+    upload.messages = chunks->size();
+    upload.started_at = now;
+    upload.last_activity = now;
+  }
+  for (const auto &chunk : *chunks) {
+    px4_client_.pub_trajectory(chunk);
+  }
+  spdlog::info("Trajectory {:08x} for drone {}: {} points in {} messages", upload_id, id,
+               points.size(), chunks->size());
+}
+
+void ImguiClient::service_trajectory_uploads() {
+  struct Resend {
+    std::shared_ptr<const std::vector<std::vector<uint8_t>>> chunks;
+    size_t from = 0;
+  };
+  std::vector<Resend> resend;
+  const auto now = clock::now();
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    for (auto &[id, upload] : trajectory_upload_map_) {
+      if (upload.phase != TrajectoryUploadState::Phase::SENDING) continue;
+      const double quiet_ms = elapsed_ms(upload.last_activity, now);
+      if (quiet_ms >= kAckTimeoutMs) {
+        if (upload.retries >= kAckMaxRetries) {
+          upload.phase = TrajectoryUploadState::Phase::FAILED;
+          spdlog::warn("Trajectory {:08x} for drone {}: no ack after {} retries",
+                       upload.upload_id, id, upload.retries);
+          continue;
+        }
+        ++upload.retries;
+        upload.last_activity = now;
+        upload.messages += upload.chunks->size() - upload.next_seq;
+        resend.push_back({upload.chunks, upload.next_seq});
+      }
+      // Resends ride on frames; make sure one comes when the timeout does.
+      redraw_.request_by(steady_after_ms(quiet_ms >= kAckTimeoutMs ? kAckTimeoutMs
+                                                                   : kAckTimeoutMs - quiet_ms));
+    }
+  }
+  for (const auto &r : resend) {
+    for (size_t seq = r.from; seq < r.chunks->size(); ++seq) {
+      px4_client_.pub_trajectory((*r.chunks)[seq]);
+    }
+  }
+}
+
+void ImguiClient::render_group_panel(
+    const std::vector<std::pair<uint8_t, ServerPayload>> &drones) {
+  auto &group = group_editor_;
+  const ImGuiStyle &style = ImGui::GetStyle();
+  ImGui::PushID("Group");
+
+  // --- Selection: one chip per drone, wrapped to the panel width ---
+  std::vector<std::pair<uint8_t, ServerPayload>> targets;
+  for (const auto &entry : drones) {
+    if (group.selection.count(entry.first) != 0) targets.push_back(entry);
+  }
+  if (targets.size() > kGroupMaxMembers) targets.resize(kGroupMaxMembers);
+  if (ImGui::SmallButton("All")) {
+    for (const auto &[id, _] : drones) group.selection.insert(id);
+  }
+  ImGui::SameLine();
+  if (ImGui::SmallButton("None")) group.selection.clear();
+  ImGui::SameLine();
+  ImGui::TextDisabled("%zu of %zu selected (Ctrl+click tiles to toggle)", targets.size(),
+                      drones.size());
+  const float row_w = ImGui::GetContentRegionAvail().x;
+  float row_x = 0.0f;
+  for (const auto &[id, _] : drones) {
+    char label[8];
+    std::snprintf(label, sizeof(label), "#%u", id);
+    const float w = ImGui::CalcTextSize(label).x + 2.0f * style.FramePadding.x;
+    if (row_x > 0.0f && row_x + w <= row_w) {
+      ImGui::SameLine();
+    } else {
+      row_x = 0.0f;
+    }
+    row_x += w + style.ItemSpacing.x;
+    const bool selected = group.selection.count(id) != 0;
+    ImGui::PushStyleColor(ImGuiCol_Button, selected ? drone_color(id) : IM_COL32(45, 45, 55, 255));
+    if (ImGui::SmallButton(label)) {
+      if (selected) {
+        group.selection.erase(id);
+      } else {
+        group.selection.insert(id);
+      }
+    }
+    ImGui::PopStyleColor();
+  }
+
+  // --- Commands: one message for the whole selection ---
+  ImGui::BeginDisabled(targets.empty());
+  for (const ClientCommand cmd : {ClientCommand::ARM, ClientCommand::ENTER_OFFBOARD,
+                                  ClientCommand::TAKEOFF, ClientCommand::FORCE_HOVER,
+                                  ClientCommand::LAND}) {
+    if (ImGui::Button(CommandStr[static_cast<int>(cmd)])) send_group_command(cmd, targets);
+    ImGui::SameLine(0, 4.0f);
+  }
+  ImGui::PushStyleColor(ImGuiCol_Button, IM_COL32(180, 30, 30, 255));
+  if (ImGui::Button("FORCE_DISARM")) ImGui::OpenPopup("Confirm Group Disarm");
+  ImGui::PopStyleColor();
+  if (ImGui::BeginPopupModal("Confirm Group Disarm", nullptr,
+                             ImGuiWindowFlags_AlwaysAutoResize)) {
+    ImGui::Text("Force disarm %zu drones? Any in the air will fall.", targets.size());
+    if (ImGui::Button("Disarm all", ImVec2(120, 0))) {
+      send_group_command(ClientCommand::FORCE_DISARM, targets);
+      ImGui::CloseCurrentPopup();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Cancel", ImVec2(120, 0))) ImGui::CloseCurrentPopup();
+    ImGui::EndPopup();
+  }
+
+  // --- Formation: anchor plus per-drone offsets or a template ---
+  ImGui::SetNextItemWidth(100.0f);
+  if (ImGui::BeginCombo("##Formation", FormationName[static_cast<int>(group.formation)])) {
+    for (size_t i = 0; i < std::size(FormationName); ++i) {
+      const auto formation = static_cast<Formation>(i);
+      if (ImGui::Selectable(FormationName[i], group.formation == formation)) {
+        group.formation = formation;
+      }
+    }
+    ImGui::EndCombo();
+  }
+  ImGui::SameLine(0, 4.0f);
+  const float afw = 70.0f;
+  ImGui::PushItemWidth(afw);
+  ImGui::InputFloat("##AX", &group.anchor[0], 0.0f, 0.0f, "X:%.1f"); ImGui::SameLine(0, 4.0f);
+  ImGui::InputFloat("##AY", &group.anchor[1], 0.0f, 0.0f, "Y:%.1f"); ImGui::SameLine(0, 4.0f);
+  ImGui::InputFloat("##AZ", &group.anchor[2], 0.0f, 0.0f, "Z:%.1f"); ImGui::SameLine(0, 4.0f);
+  ImGui::InputFloat("##AYaw", &group.anchor[3], 0.0f, 0.0f, "Y:%.2f");
+  if (group.formation != Formation::OFFSETS) {
+    ImGui::SameLine(0, 4.0f);
+    ImGui::InputFloat("##Spacing", &group.spacing, 0.0f, 0.0f, "gap %.1f m");
+    group.spacing = std::max(group.spacing, 0.1F);
+  }
+  ImGui::PopItemWidth();
+  ImGui::SameLine(0, 4.0f);
+  if (ImGui::SmallButton("From current")) {
+    // Anchor at the selection's centroid; offsets are each hover target
+    // from it in the anchor frame, so moving the anchor moves them together.
+    std::array<float, 3> sum{};
+    for (const auto &[id, drone] : targets) {
+      for (size_t k = 0; k < 3; ++k) sum[k] += drone.hover_pos[k];
+    }
+    const float n = static_cast<float>(std::max<size_t>(targets.size(), 1));
+    group.anchor = {sum[0] / n, sum[1] / n, sum[2] / n, group.anchor[3]};
+    const float c = std::cos(group.anchor[3]);
+    const float s = std::sin(group.anchor[3]);
+    group.offsets.clear();
+    for (const auto &[id, drone] : targets) {
+      const float dx = drone.hover_pos[0] - group.anchor[0];
+      const float dy = drone.hover_pos[1] - group.anchor[1];
+      const float yaw = static_cast<float>(to_yaw({drone.hover_quat[0], drone.hover_quat[1],
+                                                   drone.hover_quat[2], drone.hover_quat[3]}));
+      group.offsets[id] = {c * dx + s * dy, -s * dx + c * dy,
+                           drone.hover_pos[2] - group.anchor[2], yaw - group.anchor[3]};
+    }
+  }
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Anchor at the selected drones' centroid and record their hover\n"
+                      "targets around it; OFFSETS then moves them as one block.");
+  }
+  const bool offsets_ready =
+      group.formation != Formation::OFFSETS ||
+      std::all_of(targets.begin(), targets.end(),
+                  [&](const auto &entry) { return group.offsets.count(entry.first) != 0; });
+  ImGui::SameLine(0, 4.0f);
+  ImGui::BeginDisabled(!offsets_ready);
+  if (ImGui::Button("Send formation")) {
+    send_group_command(ClientCommand::CHANGE_HOVER_POS, targets);
+  }
+  ImGui::EndDisabled();
+  if (!offsets_ready) {
+    ImGui::SameLine();
+    ImGui::TextDisabled("use \"From current\" first");
+  }
+  ImGui::EndDisabled();
+
+  // --- Recent group commands and click-to-ack latency ---
+  std::vector<GroupCommandState> recent;
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    recent.assign(group_commands_.begin(), group_commands_.end());
+  }
+  if (!recent.empty() &&
+      ImGui::BeginTable("##GroupLog", 6,
+                        ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                            ImGuiTableFlags_SizingFixedFit)) {
+    ImGui::TableSetupColumn("seq");
+    ImGui::TableSetupColumn("command");
+    ImGui::TableSetupColumn("acked");
+    ImGui::TableSetupColumn("published");
+    ImGui::TableSetupColumn("all acked");
+    ImGui::TableSetupColumn("msgs");
+    ImGui::TableHeadersRow();
+    for (const auto &command : recent) {
+      const size_t total = command.members.size();
+      const size_t acked = command.ack_ms.size();
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%08x", command.header.seq);
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(CommandStr[static_cast<int>(command.header.command)]);
+      ImGui::TableNextColumn();
+      const ImVec4 color = command.failed || !command.rejected.empty()
+                               ? ImVec4(0.95f, 0.3f, 0.25f, 1.0f)
+                           : acked == total ? ImVec4(0.3f, 0.9f, 0.4f, 1.0f)
+                                            : ImVec4(0.95f, 0.8f, 0.3f, 1.0f);
+      ImGui::TextColored(color, "%zu/%zu", acked, total);
+      if (ImGui::IsItemHovered() && (acked < total || !command.rejected.empty())) {
+        std::string missing;
+        std::string rejected;
+        for (const auto &m : command.members) {
+          if (command.ack_ms.count(m.id) == 0) missing += " #" + std::to_string(m.id);
+          if (command.rejected.count(m.id) != 0) rejected += " #" + std::to_string(m.id);
+        }
+        ImGui::SetTooltip("missing:%s\nrejected:%s", missing.empty() ? " -" : missing.c_str(),
+                          rejected.empty() ? " -" : rejected.c_str());
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%.2f ms", command.publish_ms);
+      ImGui::TableNextColumn();
+      if (command.all_acked_ms >= 0.0) {
+        ImGui::Text("%.1f ms", command.all_acked_ms);
+      } else {
+        ImGui::TextDisabled(command.failed ? "no ack" : "waiting");
+      }
+      ImGui::TableNextColumn();
+      ImGui::Text("%zu", command.messages);
+    }
+    ImGui::EndTable();
+  }
+  ImGui::PopID();
+}
+
+void ImguiClient::send_group_command(
+    ClientCommand cmd, const std::vector<std::pair<uint8_t, ServerPayload>> &targets) {
+  if (targets.empty()) return;
+  const auto clicked = clock::now();
+  const auto &group = group_editor_;
+
+  GroupCommandHeader header{};
+  header.seq = next_group_seq_++;
+  header.command = cmd;
+  header.timestamp = static_cast<uint64_t>(to_uint64(clicked));
+  header.formation = Formation::OFFSETS;
+  if (cmd == ClientCommand::CHANGE_HOVER_POS) {
+    header.formation = group.formation;
+    header.formation_size = static_cast<uint8_t>(targets.size());
+    std::copy(group.anchor.begin(), group.anchor.end(), header.anchor);
+    header.spacing = group.spacing;
+  }
+  std::vector<GroupMember> members(targets.size());
+  for (size_t i = 0; i < targets.size(); ++i) {
+    members[i].id = targets[i].first;
+    members[i].index = static_cast<uint8_t>(i);
+    if (header.formation == Formation::OFFSETS && cmd == ClientCommand::CHANGE_HOVER_POS) {
+      const auto &offset = group.offsets.at(targets[i].first);
+      std::copy(offset.begin(), offset.end(), members[i].offset);
+    }
+  }
+  const auto message = encode_group_command(header, members);
+
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    if (cmd == ClientCommand::CHANGE_HOVER_POS) {
+      // Keep the per-drone hover inputs and keyboard control on the new targets.
+      for (const auto &member : members) {
+        hover_input_map_[member.id] = formation_target(header, member);
+      }
+    }
+    GroupCommandState state;
+    state.header = header;
+    state.members = std::move(members);
+    state.clicked_at = clicked;
+    state.last_send = clicked;
+    state.messages = 1;
+    group_commands_.push_front(std::move(state));
+    while (group_commands_.size() > kGroupHistory) group_commands_.pop_back();
+  }
+  // Registered before publishing so no ack can arrive for an unknown seq.
+  px4_client_.pub_group(message);
+  const double publish_ms = elapsed_ms(clicked, clock::now());
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    if (!group_commands_.empty() && group_commands_.front().header.seq == header.seq) {
+      group_commands_.front().publish_ms = publish_ms;
+    }
+  }
+  spdlog::info("Group {} {:08x} to {} drones in one {}-byte message",
+               CommandStr[static_cast<int>(cmd)], header.seq, targets.size(), message.size());
+}
+
+void ImguiClient::service_group_commands() {
+  std::vector<std::vector<uint8_t>> resend;
+  const auto now = clock::now();
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    for (auto &command : group_commands_) {
+      if (command.failed || command.ack_ms.size() == command.members.size()) continue;
+      const double quiet_ms = elapsed_ms(command.last_send, now);
+      if (quiet_ms >= kAckTimeoutMs) {
+        if (command.retries >= kAckMaxRetries) {
+          command.failed = true;
+          spdlog::warn("Group {} {:08x}: {} of {} drones never acknowledged",
+                       CommandStr[static_cast<int>(command.header.command)], command.header.seq,
+                       command.members.size() - command.ack_ms.size(), command.members.size());
+          continue;
+        }
+        std::vector<GroupMember> missing;
+        std::copy_if(command.members.begin(), command.members.end(),
+                     std::back_inserter(missing),
+                     [&](const GroupMember &m) { return command.ack_ms.count(m.id) == 0; });
+        ++command.retries;
+        ++command.messages;
+        command.last_send = now;
+        resend.push_back(encode_group_command(command.header, missing));
+      }
+      redraw_.request_by(steady_after_ms(quiet_ms >= kAckTimeoutMs ? kAckTimeoutMs
+                                                                   : kAckTimeoutMs - quiet_ms));
+    }
+  }
+  for (const auto &message : resend) {
+    px4_client_.pub_group(message);
+  }
+}
+
 void ImguiClient::render_plot_panel(uint8_t id, const ServerPayload &drone) {
-  TelemetryHistory h{};
+  SnapshotStore<TelemetryHistory> *store = nullptr;
   {
     std::lock_guard<std::mutex> lock(data_mutex_);
     const auto it = history_map_.find(id);
     if (it == history_map_.end()) return;
-    h = it->second;
+    store = &it->second;
+  }
+  auto &caches = plot_cache_map_[id];
+
+  uint64_t wanted = channel_bit(ChannelId::POS_X) | channel_bit(ChannelId::POS_Y);
+  for (const auto channel : plot_channels_) {
+    wanted |= channel_bit(channel);
   }
-  const float sample_hz =
-      static_cast<float>(std::max<uint32_t>(1, px4_client_.transport_paras().telemetry_hz));
+  wanted_channels_.fetch_or(wanted, std::memory_order_relaxed);
 
   float avail_h = ImGui::GetContentRegionAvail().y;
   // XY plot: 38% of available height, bounded
   float xy_h = std::clamp(avail_h * 0.38f, 130.0f, 280.0f);
-  // Remaining for 5 line plots (Z + Thrust + ωx + ωy + ωz)
+  // Remaining for the line plots
+  const float plot_count = static_cast<float>(std::max<size_t>(1, plot_channels_.size()));
   float remaining = std::max(40.0f, avail_h - xy_h - 20.0f);
-  float line_h = std::clamp(remaining / 5.0f, 38.0f, 90.0f);
+  float line_h = std::clamp(remaining / plot_count, 38.0f, 90.0f);
+
+  // Each plot is a label line plus its child; one scrolled out of view only
+  // reserves its space.
+  const float label_h = ImGui::GetTextLineHeightWithSpacing();
+  const float spacing_y = ImGui::GetStyle().ItemSpacing.y;
+  auto plot_visible = [&](float child_h) {
+    const ImVec2 extent(ImGui::GetContentRegionAvail().x, label_h + child_h);
+    if (ImGui::IsRectVisible(extent)) {
+      ++cull_stats_.plots_drawn;
+      return true;
+    }
+    ImGui::Dummy(extent);
+    ++cull_stats_.plots_culled;
+    return false;
+  };
+  const float panel_h = ImGui::GetFrameHeightWithSpacing() + label_h + xy_h + 2.0f * spacing_y +
+                        plot_count * (label_h + line_h + spacing_y);
+  if (!ImGui::IsRectVisible(ImVec2(ImGui::GetContentRegionAvail().x, panel_h))) {
+    cull_stats_.plots_culled += 1 + static_cast<int>(plot_channels_.size());
+    ImGui::Dummy(ImVec2(ImGui::GetContentRegionAvail().x, panel_h));
+    render_safety_popup(id);
+    return;
+  }
+  // Immutable until the next snapshot() call for this drone.
+  const TelemetryHistory &h = store->snapshot();
 
   if (ImGui::SmallButton("Safety")) {
     ImGui::OpenPopup("Safety Limits");
   }
-  render_xy_plot("##XYPlot", h.xy_trace, ImVec2(0, xy_h),
-                 drone.geofence_min, drone.geofence_max,
-                 drone.enable_geofence != 0);
-  ImGui::Spacing();
+  // Draw from the finest pyramid level that still holds the whole visible
+  // span (or everything received so far), so each plot touches at most one
+  // level's worth of points whatever the zoom.
+  const double span = plot_span_sec_;
+  const double t_end = h.raw.empty() ? 0.0 : h.raw.stamps().back();
+  const double t_begin = t_end - span;
+  const PyramidLevel *level = nullptr;
+  if (h.raw.size() == h.raw.capacity() &&
+      h.raw.stamps().back() - h.raw.stamps().front() < span) {
+    for (const auto &candidate : h.levels) {
+      level = &candidate;
+      if (candidate.size() < candidate.capacity() || candidate.span_sec() >= span) break;
+    }
+  }
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(140.0F);
+  ImGui::SliderFloat("##Span", &plot_span_sec_, 0.05F, 36000.0F, "span %.2f s",
+                     ImGuiSliderFlags_Logarithmic);
+  ImGui::SameLine();
+  if (level != nullptr) {
+    ImGui::TextDisabled("%zux", level->factor());
+  } else {
+    ImGui::TextDisabled("raw");
+  }
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(120.0F);
+  if (ImGui::BeginCombo("##AddPlot", "+ plot")) {
+    for (const auto &info : kChannels) {
+      if (std::find(plot_channels_.begin(), plot_channels_.end(), info.id) !=
+          plot_channels_.end()) {
+        continue;
+      }
+      if (ImGui::Selectable(info.name)) {
+        plot_channels_.push_back(info.id);
+      }
+    }
+    ImGui::EndCombo();
+  }
 
-  float z_range = drone.geofence_max[2] - drone.geofence_min[2];
-  float z_margin = std::max(0.2f, z_range * 0.05f);
-  float z_min = drone.geofence_min[2] - z_margin;
-  float z_max = drone.geofence_max[2] + z_margin;
-  render_line_plot("Z (m)", h.z, ImVec2(0, line_h), sample_hz, z_min, z_max,
-                   IM_COL32(80, 220, 100, 255));
+  if (plot_visible(xy_h)) {
+    render_xy_plot("##XYPlot", h.raw, t_begin, h.version, caches.xy, ImVec2(0, xy_h),
+                   drone.geofence_min, drone.geofence_max,
+                   drone.enable_geofence != 0);
+  }
   ImGui::Spacing();
 
-  render_line_plot("Thrust", h.thrust, ImVec2(0, line_h), sample_hz, 0.0F, 1.0F,
-                   IM_COL32(255, 200, 80, 255));
-  float w_margin = (drone.omega_max - drone.omega_min) * 0.05f;
-  float w_min = drone.omega_min - w_margin;
-  float w_max = drone.omega_max + w_margin;
-  render_line_plot("Omega X", h.omega_x, ImVec2(0, line_h), sample_hz, w_min, w_max,
-                   IM_COL32(255, 100, 100, 255));
-  render_line_plot("Omega Y", h.omega_y, ImVec2(0, line_h), sample_hz, w_min, w_max,
-                   IM_COL32(80, 180, 255, 255));
-  render_line_plot("Omega Z", h.omega_z, ImVec2(0, line_h), sample_hz, w_min, w_max,
-                   IM_COL32(180, 130, 255, 255));
+  std::optional<ChannelId> remove;
+  for (const auto channel : plot_channels_) {
+    const auto &info = channel_info(channel);
+    const auto c = static_cast<size_t>(channel);
+    float min_v = FLT_MAX;
+    float max_v = FLT_MAX;
+    channel_bounds(channel, drone, min_v, max_v);
+
+    char label[48];
+    if (info.unit[0] != '\0') {
+      std::snprintf(label, sizeof(label), "%s (%s)", info.name, info.unit);
+    } else {
+      std::snprintf(label, sizeof(label), "%s", info.name);
+    }
+    if (!plot_visible(line_h)) continue;
+    ImGui::PushID(static_cast<int>(c));
+    if (ImGui::SmallButton("x")) {
+      remove = channel;
+    }
+    ImGui::PopID();
+    ImGui::SameLine();
+    if (level != nullptr) {
+      render_envelope_plot(label, *level, channel, t_begin, t_end, h.version,
+                           caches.envelope[c], ImVec2(0, line_h), min_v, max_v,
+                           channel_color(channel));
+    } else {
+      render_line_plot(label, id, h.raw, channel, t_begin, t_end, h.version, caches.line[c],
+                       ImVec2(0, line_h), min_v, max_v, channel_color(channel));
+    }
+  }
+  if (remove) {
+    plot_channels_.erase(std::find(plot_channels_.begin(), plot_channels_.end(), *remove));
+  }
   render_safety_popup(id);
 }
 
+void ImguiClient::render_scene_panel(
+    const std::vector<std::pair<uint8_t, ServerPayload>> &drones) {
+  if (!gl_scene_.ready()) {
+    ImGui::TextDisabled("3D view needs OpenGL 3.3");
+    return;
+  }
+
+  scene_drones_.clear();
+  std::array<float, 3> centroid{};
+  for (const auto &[id, drone] : drones) {
+    GlSceneRenderer::Drone d;
+    d.id = id;
+    d.color = drone_color(id);
+    std::copy(std::begin(drone.pos), std::end(drone.pos), d.pos.begin());
+    std::copy(std::begin(drone.quat), std::end(drone.quat), d.quat.begin());
+    std::copy(std::begin(drone.geofence_min), std::end(drone.geofence_min), d.fence_min.begin());
+    std::copy(std::begin(drone.geofence_max), std::end(drone.geofence_max), d.fence_max.begin());
+    d.fence_enabled = drone.enable_geofence != 0;
+    if (drone.mission_phase == static_cast<int32_t>(MissionPhase::HOVER)) {
+      d.hover = {drone.hover_pos[0], drone.hover_pos[1], drone.hover_pos[2]};
+    }
+    SnapshotStore<TelemetryHistory> *store = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(data_mutex_);
+      const auto it = history_map_.find(id);
+      if (it != history_map_.end()) store = &it->second;
+    }
+    if (store != nullptr) d.trail = &store->snapshot().trail;
+    for (int i = 0; i < 3; ++i) {
+      centroid[i] += d.pos[i] / static_cast<float>(drones.size());
+    }
+    scene_drones_.push_back(d);
+  }
+
+  ImGui::Checkbox("Follow", &scene_follow_);
+  ImGui::SameLine();
+  ImGui::TextDisabled("left drag: orbit, right drag: pan, wheel: zoom");
+  if (scene_follow_) scene_camera_.target = centroid;
+
+  const ImVec2 p0 = ImGui::GetCursorScreenPos();
+  const ImVec2 size = ImGui::GetContentRegionAvail();
+  if (size.x < 8.0F || size.y < 8.0F) return;
+  ImGui::InvisibleButton("##SceneView", size,
+                         ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight);
+  const ImGuiIO &io = ImGui::GetIO();
+  auto &cam = scene_camera_;
+  if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+    cam.yaw -= io.MouseDelta.x * 0.01F;
+    cam.pitch = std::clamp(cam.pitch + io.MouseDelta.y * 0.01F, -1.45F, 1.45F);
+  }
+  if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Right)) {
+    // Pan on the ground plane: screen x along the camera's right vector,
+    // screen y along its forward vector.
+    scene_follow_ = false;
+    const float k = cam.distance * 0.002F;
+    const float cy = std::cos(cam.yaw);
+    const float sy = std::sin(cam.yaw);
+    cam.target[0] += (sy * io.MouseDelta.x - cy * io.MouseDelta.y) * k;
+    cam.target[1] += (-cy * io.MouseDelta.x - sy * io.MouseDelta.y) * k;
+  }
+  if (ImGui::IsItemHovered() && io.MouseWheel != 0.0F) {
+    cam.distance = std::clamp(cam.distance * std::pow(0.9F, io.MouseWheel), 2.0F, 500.0F);
+  }
+
+  const ImTextureID texture = gl_scene_.render(size, cam, scene_drones_);
+  if (texture == ImTextureID{}) return;
+  ImDrawList *draw = ImGui::GetWindowDrawList();
+  const ImVec2 p1(p0.x + size.x, p0.y + size.y);
+  draw->AddImage(texture, p0, p1, ImVec2(0, 1), ImVec2(1, 0));
+  for (const auto &d : scene_drones_) {
+    if (const auto at = gl_scene_.project(d.pos)) {
+      char tag[8];
+      std::snprintf(tag, sizeof(tag), "#%u", d.id);
+      draw->AddText(ImVec2(p0.x + at->x + 6.0F, p0.y + at->y - 14.0F), d.color, tag);
+    }
+  }
+}
+
+void ImguiClient::request_interaction_frames() {
+  using namespace std::chrono_literals;
+  const auto now = RedrawScheduler::steady::now();
+  if (ImGui::IsAnyItemActive()) {
+    redraw_.request_animation(); // drags, held buttons, sliders
+  } else if (ImGui::GetIO().WantTextInput) {
+    redraw_.request_by(now + 250ms); // cursor blink
+  } else if (ImGui::IsAnyItemHovered()) {
+    redraw_.request_by(now + 100ms); // delayed tooltips
+  }
+}
+
+void ImguiClient::render_dispatch_tooltip() {
+  auto stats = px4_client_.server_data.stats();
+  const auto log_stats = px4_client_.log_data.stats();
+  stats.insert(stats.end(), log_stats.begin(), log_stats.end());
+
+  const auto redraw = redraw_.stats();
+
+  ImGui::BeginTooltip();
+  ImGui::TextUnformatted("Redraw");
+  ImGui::Separator();
+  ImGui::Text("%.1f FPS (cap %.0f)  render thread idle %.0f%%  process CPU %.0f%%",
+              redraw.fps, redraw_.max_fps(), redraw.idle * 100.0, redraw.cpu * 100.0);
+  ImGui::Text("sample to swap %.1f ms avg, %.1f ms max", redraw.latency_avg_ms,
+              redraw.latency_max_ms);
+  const auto control = control_loop_->stats();
+  ImGui::Spacing();
+  ImGui::TextUnformatted("Control loop");
+  ImGui::Separator();
+  ImGui::Text("%.1f Hz (target %.0f)  jitter %.2f ms avg, %.2f ms max  tick max %.2f ms",
+              control.rate_hz, 1.0 / control_loop_->period_sec(), control.jitter_avg_ms,
+              control.jitter_max_ms, control.tick_max_ms);
+  ImGui::Text("ticks %llu  overruns %llu", static_cast<unsigned long long>(control.ticks),
+              static_cast<unsigned long long>(control.overruns));
+  const auto latency = input_latency_.stats();
+  ImGui::Text("input sample to publish %.2f ms avg, %.2f ms max (%llu changes)",
+              latency.avg_ms, latency.max_ms, static_cast<unsigned long long>(latency.count));
+  ImGui::Spacing();
+  ImGui::TextUnformatted("Observer queues");
+  ImGui::Separator();
+  for (const auto &s : stats) {
+    ImGui::Text("%-8s %-11s depth %zu (max %zu)  delivered %llu  dropped %llu",
+                s.name.c_str(), DispatchPolicyName[static_cast<int>(s.policy)], s.depth,
+                s.max_depth, static_cast<unsigned long long>(s.delivered),
+                static_cast<unsigned long long>(s.dropped));
+  }
+  ImGui::EndTooltip();
+}
+
 void ImguiClient::publish_heartbeat() {
   const auto now = clock::now();
-  if (timeDuration(last_heartbeat_time_, now) < heartbeat_interval_ms_) {
+  const double since_ms = timeDuration(last_heartbeat_time_, now);
+  // Heartbeats ride on frames, so make sure the next one is rendered in time.
+  const double next_ms = since_ms < heartbeat_interval_ms_
+                             ? heartbeat_interval_ms_ - since_ms
+                             : heartbeat_interval_ms_;
+  redraw_.request_by(RedrawScheduler::steady::now() +
+                     std::chrono::duration_cast<RedrawScheduler::steady::duration>(
+                         std::chrono::duration<double, std::milli>(next_ms)));
+  if (since_ms < heartbeat_interval_ms_) {
     return;
   }
   last_heartbeat_time_ = now;
@@ -1206,8 +2564,262 @@ void ImguiClient::publish_heartbeat() {
   }
 }
 
+void ImguiClient::render_fleet_tiles(
+    const std::vector<std::pair<uint8_t, ServerPayload>> &drones) {
+  constexpr float kTileW = 230.0f;
+  constexpr float kTileH = 92.0f;
+  const ImGuiStyle &style = ImGui::GetStyle();
+  wanted_channels_.fetch_or(channel_bit(ChannelId::POS_Z), std::memory_order_relaxed);
+
+  const ImVec2 avail = ImGui::GetContentRegionAvail();
+  const int cols = std::max(
+      1, static_cast<int>((avail.x + style.ItemSpacing.x) / (kTileW + style.ItemSpacing.x)));
+  const int rows = (static_cast<int>(drones.size()) + cols - 1) / cols;
+  const float row_h = kTileH + style.ItemSpacing.y;
+  // With a drone focused the grid shrinks to a strip above its panels.
+  const bool has_focus = std::any_of(drones.begin(), drones.end(), [&](const auto &entry) {
+    return static_cast<int>(entry.first) == focused_id_;
+  });
+  const float grid_h = std::min(static_cast<float>(rows) * row_h,
+                                has_focus ? std::max(row_h, avail.y * 0.3f) : avail.y);
+
+  for (const auto &[id, _] : drones) {
+    section_visible_map_[id] = false;
+  }
+  const int tiles_before = cull_stats_.tiles_drawn;
+  ImGui::BeginChild("Fleet", ImVec2(0, grid_h), false);
+  // Only rows inside the scroll region are built; the rest cost nothing.
+  ImGuiListClipper clipper;
+  clipper.Begin(rows, row_h);
+  while (clipper.Step()) {
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+      for (int col = 0; col < cols; ++col) {
+        const size_t i = static_cast<size_t>(row * cols + col);
+        if (i >= drones.size()) break;
+        if (col > 0) ImGui::SameLine();
+        render_fleet_tile(drones[i].first, drones[i].second, ImVec2(kTileW, kTileH));
+      }
+    }
+  }
+  clipper.End();
+  ImGui::EndChild();
+  cull_stats_.tiles_culled +=
+      static_cast<int>(drones.size()) - (cull_stats_.tiles_drawn - tiles_before);
+}
+
+void ImguiClient::render_fleet_tile(uint8_t id, const ServerPayload &drone, ImVec2 size) {
+  constexpr double kSparkSpanSec = 10.0;
+  ImGui::PushID(id);
+  const ImVec2 p0 = ImGui::GetCursorScreenPos();
+  const ImVec2 p1(p0.x + size.x, p0.y + size.y);
+  const bool focused = focused_id_ == static_cast<int>(id);
+  const bool selected = group_editor_.selection.count(id) != 0;
+  if (ImGui::InvisibleButton("##Tile", size)) {
+    if (ImGui::GetIO().KeyCtrl) {
+      if (selected) {
+        group_editor_.selection.erase(id);
+      } else {
+        group_editor_.selection.insert(id);
+      }
+    } else {
+      focused_id_ = focused ? -1 : static_cast<int>(id);
+    }
+  }
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Click to %s the panels of #%u\nCtrl+click to %s it for group commands",
+                      focused ? "close" : "open", id, selected ? "deselect" : "select");
+  }
+  section_visible_map_[id] = true;
+  ++cull_stats_.tiles_drawn;
+
+  ImDrawList *draw = ImGui::GetWindowDrawList();
+  draw->AddRectFilled(p0, p1, IM_COL32(26, 26, 32, 255), 4.0f);
+  draw->AddRect(p0, p1, focused ? IM_COL32(50, 240, 90, 255) : IM_COL32(70, 70, 80, 255),
+                4.0f, 0, focused ? 2.0f : 1.0f);
+  draw->PushClipRect(p0, p1, true);
+  if (selected) {
+    draw->AddRectFilled(ImVec2(p1.x - 10.0f, p0.y + 2.0f), ImVec2(p1.x - 2.0f, p0.y + 10.0f),
+                        IM_COL32(80, 180, 255, 255), 2.0f);
+  }
+
+  const float line = ImGui::GetTextLineHeight();
+  const float x = p0.x + 6.0f;
+  float y = p0.y + 4.0f;
+  char text[64];
+  std::snprintf(text, sizeof(text), "#%u", id);
+  draw->AddText(ImVec2(x, y), drone_color(id), text);
+
+  const int phase = drone.mission_phase;
+  const bool phase_valid = phase >= 0 && phase < static_cast<int>(std::size(MissionPhaseName));
+  const char *phase_name = phase_valid ? MissionPhaseName[phase] : "UNKNOWN";
+  const float bx = x + 36.0f;
+  const float bw = ImGui::CalcTextSize(phase_name).x + 8.0f;
+  draw->AddRectFilled(ImVec2(bx, y - 1.0f), ImVec2(bx + bw, y + line + 1.0f),
+                      PhaseColor(phase), 3.0f);
+  draw->AddText(ImVec2(bx + 4.0f, y), IM_COL32(255, 255, 255, 255), phase_name);
+  if (drone.armed_state != 0) {
+    draw->AddText(ImVec2(bx + bw + 8.0f, y), IM_COL32(255, 120, 90, 255), "ARMED");
+  }
+  y += line + 4.0f;
+
+  const float batt_pct = drone.battery_remaining * 100.0f;
+  if (drone.battery_remaining > 0.0f) {
+    std::snprintf(text, sizeof(text), "Bat %.0f%% %.1fV", batt_pct, drone.battery_voltage);
+    draw->AddText(ImVec2(x, y), battery_color(batt_pct), text);
+  } else {
+    std::snprintf(text, sizeof(text), "Bat %.1fV", drone.battery_voltage);
+    draw->AddText(ImVec2(x, y), IM_COL32(180, 180, 180, 255), text);
+  }
+  if (drone.guard_flags != 0) {
+    const std::string guards = guard_flags_text(drone.guard_flags);
+    draw->AddText(ImVec2(x + 110.0f, y), IM_COL32(255, 90, 60, 255), guards.c_str());
+  }
+  y += line + 4.0f;
+
+  // Altitude sparkline over the last few seconds of raw history.
+  SnapshotStore<TelemetryHistory> *store = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    const auto it = history_map_.find(id);
+    if (it != history_map_.end()) store = &it->second;
+  }
+  if (store != nullptr) {
+    const TelemetryRing &ring = store->snapshot().raw;
+    const auto all_stamps = ring.stamps(ChannelId::POS_Z);
+    if (ring.size(ChannelId::POS_Z) >= 2) {
+      const double t_end = all_stamps.back();
+      const double t_begin = t_end - kSparkSpanSec;
+      const size_t first = ring_lower_bound(all_stamps, t_begin, std::identity{});
+      const size_t count = all_stamps.size() - first;
+      const auto stamps = all_stamps.subview(first, count);
+      const auto values = ring.channel(ChannelId::POS_Z).subview(first, count);
+      float lo = 0.0f;
+      float hi = 0.0f;
+      view_extrema(values, lo, hi);
+      if (hi - lo < 0.5f) {
+        const float mid = 0.5f * (lo + hi);
+        lo = mid - 0.25f;
+        hi = mid + 0.25f;
+      }
+      const float sx0 = x;
+      const float sx1 = p1.x - 52.0f;
+      const float sy0 = y;
+      const float sy1 = p1.y - 4.0f;
+      spark_points_.clear();
+      m4_decimate(stamps, values, t_begin, t_end, static_cast<size_t>(std::max(1.0f, sx1 - sx0)),
+                  [&](const size_t i) {
+                    const float u = static_cast<float>((stamps[i] - t_begin) / kSparkSpanSec);
+                    const float v = (values[i] - lo) / (hi - lo);
+                    spark_points_.emplace_back(sx0 + u * (sx1 - sx0), sy1 - v * (sy1 - sy0));
+                  });
+      if (spark_points_.size() >= 2) {
+        draw->AddPolyline(spark_points_.data(), static_cast<int>(spark_points_.size()),
+                          channel_color(ChannelId::POS_Z), ImDrawFlags_None, 1.2f);
+      }
+      std::snprintf(text, sizeof(text), "z %.1fm", values.back());
+      draw->AddText(ImVec2(sx1 + 6.0f, sy0 + 0.5f * (sy1 - sy0 - line)),
+                    IM_COL32(170, 170, 180, 255), text);
+    }
+  }
+
+  draw->PopClipRect();
+  ImGui::PopID();
+}
+
+void ImguiClient::render_drone_section(uint8_t id, const ServerPayload &drone,
+                                       float body_h) {
+  // A section scrolled out of view keeps its last measured height but
+  // builds nothing: no history snapshot, no tables, no plots.
+  const ImVec2 section_min = ImGui::GetCursorScreenPos();
+  const float section_w = ImGui::GetContentRegionAvail().x;
+  const auto known_h = section_height_map_.find(id);
+  const float section_h = known_h != section_height_map_.end()
+                              ? known_h->second
+                              : body_h + 2.0f * ImGui::GetFrameHeightWithSpacing();
+  if (!ImGui::IsRectVisible(section_min,
+                            ImVec2(section_min.x + section_w, section_min.y + section_h))) {
+    ImGui::Dummy(ImVec2(section_w, std::max(0.0f, section_h - ImGui::GetStyle().ItemSpacing.y)));
+    section_visible_map_[id] = false;
+    ++cull_stats_.sections_culled;
+    return;
+  }
+  ++cull_stats_.sections_drawn;
+
+  ImGui::PushID(id);
+
+  // Title + FPS on same line as header start
+  const bool focused = focused_id_ == static_cast<int>(id);
+  ImGui::TextColored(focused ? ImVec4(0.2f, 0.95f, 0.35f, 1.0f)
+                             : ImGui::GetStyleColorVec4(ImGuiCol_Text),
+                     "PX4CTRL #%u", id);
+  if (ImGui::IsItemClicked()) {
+    focused_id_ = focused ? -1 : static_cast<int>(id);
+  }
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Click to %s full-rate telemetry", focused ? "release" : "focus");
+  }
+  ImGui::SameLine(0, 10.0f);
+  render_header_bar(drone);
+
+  ImGui::Separator();
+
+  if (ImGui::BeginTable("Body", 2,
+                        ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV |
+                            ImGuiTableFlags_SizingStretchProp,
+                        ImVec2(0, body_h))) {
+    float w = ImGui::GetContentRegionAvail().x;
+    float left_w = std::clamp(w * 0.32f, 260.0f, 380.0f);
+    ImGui::TableSetupColumn("Info", ImGuiTableColumnFlags_WidthFixed, left_w);
+    ImGui::TableSetupColumn("Plots", ImGuiTableColumnFlags_WidthStretch);
+
+    ImGui::TableNextColumn();
+    ImGui::BeginChild("LeftCol", ImVec2(0, 0), false);
+    render_status_panel(id, drone);
+    ImGui::Spacing();
+    render_command_panel(id, drone);
+
+    // Log tail in left column
+    ImGui::Spacing();
+    ImGui::SeparatorText("Logs");
+    {
+      std::deque<Px4Client::LogEntry> logs_snapshot;
+      {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        logs_snapshot = log_data_;
+      }
+      int show_n = std::min(6, static_cast<int>(logs_snapshot.size()));
+      for (int i = static_cast<int>(logs_snapshot.size()) - show_n; i < static_cast<int>(logs_snapshot.size()); ++i) {
+        ImGui::PushStyleColor(ImGuiCol_Text, log_color_for_level(logs_snapshot[i].level));
+        ImGui::PushTextWrapPos(ImGui::GetCursorPos().x + ImGui::GetContentRegionAvail().x);
+        ImGui::TextUnformatted(logs_snapshot[i].text.c_str());
+        ImGui::PopTextWrapPos();
+        ImGui::PopStyleColor();
+      }
+    }
+    if (ImGui::SmallButton("Clear")) {
+      std::lock_guard<std::mutex> lock(data_mutex_);
+      log_data_.clear();
+    }
+    ImGui::EndChild();
+
+    ImGui::TableNextColumn();
+    render_plot_panel(id, drone);
+
+    ImGui::EndTable();
+  }
+
+  const ImVec2 section_max(section_min.x + ImGui::GetContentRegionAvail().x,
+                           ImGui::GetCursorScreenPos().y);
+  section_visible_map_[id] = ImGui::IsRectVisible(section_min, section_max);
+  section_height_map_[id] = section_max.y - section_min.y;
+
+  ImGui::PopID();
+}
+
 void ImguiClient::render_window() {
-  ImGuiIO &io = ImGui::GetIO();
+  gl_lines_.new_frame();
+  last_cull_stats_ = cull_stats_;
+  cull_stats_ = {};
   ImGuiViewport *viewport = ImGui::GetMainViewport();
   ImGui::SetNextWindowPos(viewport->WorkPos);
   ImGui::SetNextWindowSize(viewport->WorkSize);
@@ -1229,75 +2841,71 @@ void ImguiClient::render_window() {
     // Still process keyboard + heartbeats even without drones
     handle_keyboard_control();
     publish_heartbeat();
+    service_trajectory_uploads();
+    service_group_commands();
+    request_interaction_frames();
     ImGui::End();
     return;
   }
 
-  float body_h = ImGui::GetContentRegionAvail().y;
-
-  for (const auto &[id, drone] : drones) {
-    ImGui::PushID(id);
-
-    // Title + FPS on same line as header start
-    ImGui::Text("PX4CTRL #%u", id);
-    ImGui::SameLine(0, 10.0f);
-    render_header_bar(drone);
-    ImGui::SameLine();
-    ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100.0f);
-    ImGui::TextColored(ImVec4(0.45f, 0.45f, 0.55f, 1.0f), "%.0f FPS", io.Framerate);
-
-    ImGui::Separator();
-
-    if (ImGui::BeginTable("Body", 2,
-                          ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV |
-                              ImGuiTableFlags_SizingStretchProp,
-                          ImVec2(0, body_h))) {
-      float w = ImGui::GetContentRegionAvail().x;
-      float left_w = std::clamp(w * 0.32f, 260.0f, 380.0f);
-      ImGui::TableSetupColumn("Info", ImGuiTableColumnFlags_WidthFixed, left_w);
-      ImGui::TableSetupColumn("Plots", ImGuiTableColumnFlags_WidthStretch);
-
-      ImGui::TableNextColumn();
-      ImGui::BeginChild("LeftCol", ImVec2(0, 0), false);
-      render_status_panel(id, drone);
-      ImGui::Spacing();
-      render_command_panel(id, drone);
-
-      // Log tail in left column
-      ImGui::Spacing();
-      ImGui::SeparatorText("Logs");
-      {
-        std::deque<Px4Client::LogEntry> logs_snapshot;
-        {
-          std::lock_guard<std::mutex> lock(data_mutex_);
-          logs_snapshot = log_data_;
-        }
-        int show_n = std::min(6, static_cast<int>(logs_snapshot.size()));
-        for (int i = static_cast<int>(logs_snapshot.size()) - show_n; i < static_cast<int>(logs_snapshot.size()); ++i) {
-          ImGui::PushStyleColor(ImGuiCol_Text, log_color_for_level(logs_snapshot[i].level));
-          ImGui::PushTextWrapPos(ImGui::GetCursorPos().x + ImGui::GetContentRegionAvail().x);
-          ImGui::TextUnformatted(logs_snapshot[i].text.c_str());
-          ImGui::PopTextWrapPos();
-          ImGui::PopStyleColor();
-        }
-      }
-      if (ImGui::SmallButton("Clear")) {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        log_data_.clear();
-      }
-      ImGui::EndChild();
-
-      ImGui::TableNextColumn();
-      render_plot_panel(id, drone);
-
-      ImGui::EndTable();
+  ImGui::Checkbox("Fleet view", &fleet_view_);
+  ImGui::SameLine();
+  ImGui::Checkbox("3D view", &show_scene_);
+  ImGui::SameLine(0, 16.0f);
+  const CullStats &cull = last_cull_stats_;
+  ImGui::TextDisabled("panels %d/%d  plots %d/%d", cull.sections_drawn + cull.tiles_drawn,
+                      cull.sections_drawn + cull.sections_culled + cull.tiles_drawn +
+                          cull.tiles_culled,
+                      cull.plots_drawn, cull.plots_drawn + cull.plots_culled);
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Built last frame / total; the rest were off-screen and skipped.\n"
+                      "sections %d drawn, %d culled\ntiles %d drawn, %d culled\n"
+                      "plots %d drawn, %d culled",
+                      cull.sections_drawn, cull.sections_culled, cull.tiles_drawn,
+                      cull.tiles_culled, cull.plots_drawn, cull.plots_culled);
+  }
+  ImGui::SameLine();
+  ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100.0f);
+  // Frames are event driven; show the scheduler's rate, not ImGui's
+  // average over the last frames.
+  ImGui::TextColored(ImVec4(0.45f, 0.45f, 0.55f, 1.0f), "%.0f FPS", redraw_.stats().fps);
+  if (ImGui::IsItemHovered()) {
+    render_dispatch_tooltip();
+  }
+  if (ImGui::CollapsingHeader("Group commands")) {
+    render_group_panel(drones);
+  }
+  if (show_scene_) {
+    const float scene_h = std::clamp(ImGui::GetContentRegionAvail().y * 0.45f, 220.0f, 520.0f);
+    ImGui::BeginChild("Scene", ImVec2(0, scene_h), true);
+    render_scene_panel(drones);
+    ImGui::EndChild();
+  }
+
+  if (fleet_view_) {
+    render_fleet_tiles(drones);
+    auto focused = std::find_if(drones.begin(), drones.end(), [&](const auto &entry) {
+      return static_cast<int>(entry.first) == focused_id_;
+    });
+    if (focused == drones.end() && drones.size() == 1) focused = drones.begin();
+    if (focused != drones.end()) {
+      render_drone_section(focused->first, focused->second, ImGui::GetContentRegionAvail().y);
+    } else {
+      ImGui::TextDisabled("Click a tile to open its panels.");
+    }
+  } else {
+    const float body_h = ImGui::GetContentRegionAvail().y;
+    for (const auto &[id, drone] : drones) {
+      render_drone_section(id, drone, body_h);
     }
-
-    ImGui::PopID();
   }
 
+  update_telemetry_rates(drones);
   handle_keyboard_control();
   publish_heartbeat();
+  service_trajectory_uploads();
+  service_group_commands();
+  request_interaction_frames();
   ImGui::End();
 }
 
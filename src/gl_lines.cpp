@@ -0,0 +1,213 @@
+#include "gl_lines.h"
+
+#include "gl_api.h"
+
+#include <algorithm>
+
+namespace px4ctrl {
+namespace ui {
+namespace {
+
+// Rebase stamps before their float offsets lose sub-millisecond precision.
+constexpr double kRebaseSec = 600.0;
+constexpr size_t kVertexFloats = 2; // (t - base, value)
+
+// One instance per segment between samples a_p0 and a_p1, expanded to a quad
+// a pixel wider than the line on each side for the anti-aliasing ramp.
+constexpr const char *kVertexShader = R"(#version 330 core
+layout(location = 0) in vec2 a_p0;
+layout(location = 1) in vec2 a_p1;
+uniform vec4 u_display; // display pos, display size
+uniform vec4 u_rect;    // plot min, plot size
+uniform vec4 u_range;   // t_begin, t_span, min_v, max_v
+uniform float u_width;
+out float v_across;
+
+vec2 to_screen(vec2 p) {
+  vec2 u = vec2((p.x - u_range.x) / u_range.y, (p.y - u_range.z) / (u_range.w - u_range.z));
+  return vec2(u_rect.x + u.x * u_rect.z, u_rect.y + (1.0 - u.y) * u_rect.w);
+}
+
+void main() {
+  vec2 s0 = to_screen(a_p0);
+  vec2 s1 = to_screen(a_p1);
+  vec2 d = s1 - s0;
+  float len = length(d);
+  vec2 dir = len > 1e-4 ? d / len : vec2(1.0, 0.0);
+  vec2 n = vec2(-dir.y, dir.x);
+  float half_w = 0.5 * u_width + 1.0;
+  float side = (gl_VertexID & 1) == 0 ? -1.0 : 1.0;
+  // Overlap neighbours by half the width so joints have no gaps.
+  vec2 end = (gl_VertexID & 2) == 0 ? s0 - dir * 0.5 * u_width : s1 + dir * 0.5 * u_width;
+  vec2 pos = end + n * side * half_w;
+  v_across = side * half_w;
+  vec2 ndc = (pos - u_display.xy) / u_display.zw * vec2(2.0, -2.0) + vec2(-1.0, 1.0);
+  gl_Position = vec4(ndc, 0.0, 1.0);
+}
+)";
+
+constexpr const char *kFragmentShader = R"(#version 330 core
+uniform vec4 u_color;
+uniform float u_width;
+in float v_across;
+out vec4 o_color;
+
+void main() {
+  float coverage = clamp(0.5 * u_width + 0.5 - abs(v_across), 0.0, 1.0);
+  o_color = vec4(u_color.rgb, u_color.a * coverage);
+}
+)";
+
+const void *slot_offset(size_t slot) {
+  return reinterpret_cast<const void *>(slot * kVertexFloats * sizeof(float));
+}
+} // namespace
+
+bool GlLineRenderer::init() {
+  if (ready()) return true;
+  if (!gl.load()) return false;
+  const GLuint program = gl_build_program("GL line renderer", kVertexShader, kFragmentShader);
+  if (program == 0) return false;
+
+  program_ = program;
+  u_display_ = gl.GetUniformLocation(program_, "u_display");
+  u_rect_ = gl.GetUniformLocation(program_, "u_rect");
+  u_range_ = gl.GetUniformLocation(program_, "u_range");
+  u_color_ = gl.GetUniformLocation(program_, "u_color");
+  u_width_ = gl.GetUniformLocation(program_, "u_width");
+
+  gl.GenVertexArrays(1, &vao_);
+  gl.BindVertexArray(vao_);
+  for (GLuint attrib = 0; attrib < 2; ++attrib) {
+    gl.EnableVertexAttribArray(attrib);
+    gl.VertexAttribDivisor(attrib, 1);
+  }
+  gl.BindVertexArray(0);
+  spdlog::info("GL line renderer ready");
+  return true;
+}
+
+void GlLineRenderer::shutdown() {
+  items_.clear();
+  if (!ready()) return;
+  for (auto &[key, series] : series_) {
+    if (series.vbo != 0) gl.DeleteBuffers(1, &series.vbo);
+  }
+  series_.clear();
+  gl.DeleteVertexArrays(1, &vao_);
+  gl.DeleteProgram(program_);
+  vao_ = 0;
+  program_ = 0;
+}
+
+void GlLineRenderer::upload(Series &series, const TelemetryRing &ring,
+                            const ChannelId channel) {
+  const uint64_t pushed = ring.pushed();
+  const size_t count = ring.size(channel);
+  if (count == 0) {
+    series.uploaded = pushed;
+    series.size = 0;
+    return;
+  }
+  const auto stamps = ring.stamps(channel);
+  const auto values = ring.channel(channel);
+  const bool full = series.vbo == 0 || series.capacity != ring.capacity() ||
+                    pushed < series.uploaded || count < series.size ||
+                    stamps.back() - series.base > kRebaseSec;
+  const size_t fresh =
+      full ? count : static_cast<size_t>(std::min<uint64_t>(pushed - series.uploaded, count));
+  if (fresh == 0) return;
+
+  if (series.vbo == 0) gl.GenBuffers(1, &series.vbo);
+  gl.BindBuffer(GL_ARRAY_BUFFER, series.vbo);
+  if (full) {
+    series.capacity = ring.capacity();
+    series.base = stamps.front();
+    gl.BufferData(GL_ARRAY_BUFFER,
+                  static_cast<GLsizeiptr>((series.capacity + 1) * kVertexFloats * sizeof(float)),
+                  nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  staging_.resize(fresh * kVertexFloats);
+  for (size_t i = 0; i < fresh; ++i) {
+    const size_t idx = count - fresh + i;
+    staging_[i * kVertexFloats] = static_cast<float>(stamps[idx] - series.base);
+    staging_[i * kVertexFloats + 1] = values[idx];
+  }
+  gl_write_ring_slots(pushed, series.capacity, fresh, staging_.data(), kVertexFloats);
+  gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+  series.uploaded = pushed;
+  series.size = count;
+}
+
+void GlLineRenderer::draw(ImDrawList *draw, const uint32_t key, const TelemetryRing &ring,
+                          const ChannelId channel, const size_t first,
+                          const Style &style) {
+  if (!ready()) return;
+  auto &series = series_[key];
+  upload(series, ring, channel);
+  if (first + 1 >= series.size) return;
+
+  Item item;
+  item.self = this;
+  item.series = &series;
+  item.first_slot =
+      static_cast<size_t>((ring.pushed() - series.size + first) % series.capacity);
+  item.segments = series.size - first - 1;
+  item.base = series.base;
+  item.style = style;
+  items_.push_back(item);
+  draw->AddCallback(&GlLineRenderer::draw_callback, &items_.back());
+  draw->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void GlLineRenderer::draw_callback(const ImDrawList * /*list*/, const ImDrawCmd *cmd) {
+  const auto *item = static_cast<const Item *>(cmd->UserCallbackData);
+  item->self->render(*item, *cmd);
+}
+
+void GlLineRenderer::render(const Item &item, const ImDrawCmd &cmd) const {
+  const ImDrawData *data = ImGui::GetDrawData();
+  const Style &style = item.style;
+  const ImVec2 clip_min(std::max(cmd.ClipRect.x, style.rect_min.x),
+                        std::max(cmd.ClipRect.y, style.rect_min.y));
+  const ImVec2 clip_max(std::min(cmd.ClipRect.z, style.rect_max.x),
+                        std::min(cmd.ClipRect.w, style.rect_max.y));
+  if (data == nullptr || clip_max.x <= clip_min.x || clip_max.y <= clip_min.y) return;
+
+  const ImVec2 scale = data->FramebufferScale;
+  const float fb_h = data->DisplaySize.y * scale.y;
+  glScissor(static_cast<GLint>((clip_min.x - data->DisplayPos.x) * scale.x),
+            static_cast<GLint>(fb_h - (clip_max.y - data->DisplayPos.y) * scale.y),
+            static_cast<GLsizei>((clip_max.x - clip_min.x) * scale.x),
+            static_cast<GLsizei>((clip_max.y - clip_min.y) * scale.y));
+
+  const ImVec4 color = ImGui::ColorConvertU32ToFloat4(style.color);
+  gl.UseProgram(program_);
+  gl.Uniform4f(u_display_, data->DisplayPos.x, data->DisplayPos.y, data->DisplaySize.x,
+               data->DisplaySize.y);
+  gl.Uniform4f(u_rect_, style.rect_min.x, style.rect_min.y,
+               style.rect_max.x - style.rect_min.x, style.rect_max.y - style.rect_min.y);
+  gl.Uniform4f(u_range_, static_cast<float>(style.t_begin - item.base),
+               static_cast<float>(style.t_span), style.min_v, style.max_v);
+  gl.Uniform4f(u_color_, color.x, color.y, color.z, color.w);
+  gl.Uniform1f(u_width_, style.thickness);
+
+  gl.BindVertexArray(vao_);
+  gl.BindBuffer(GL_ARRAY_BUFFER, item.series->vbo);
+  const auto stride = static_cast<GLsizei>(kVertexFloats * sizeof(float));
+  size_t slot = item.first_slot;
+  size_t left = item.segments;
+  while (left > 0) {
+    const size_t run = std::min(left, item.series->capacity - slot);
+    gl.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, slot_offset(slot));
+    gl.VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, slot_offset(slot + 1));
+    gl.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(run));
+    left -= run;
+    slot = 0;
+  }
+}
+
+} // namespace ui
+} // namespace px4ctrl
@@ -0,0 +1,384 @@
+#include "gl_scene.h"
+
+#include "gl_api.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace px4ctrl {
+namespace ui {
+namespace {
+
+using Vec3 = std::array<float, 3>;
+using Mat4 = std::array<float, 16>; // column-major
+
+constexpr size_t kTrailFloats = 3;   // x, y, z
+constexpr size_t kScratchFloats = 7; // x, y, z, r, g, b, a
+constexpr float kTriadLength = 0.6F;
+constexpr float kHoverMark = 0.2F;
+
+constexpr const char *kVertexShader = R"(#version 330 core
+layout(location = 0) in vec3 a_pos;
+layout(location = 1) in vec4 a_color;
+uniform mat4 u_mvp;
+out vec4 v_color;
+
+void main() {
+  v_color = a_color;
+  gl_Position = u_mvp * vec4(a_pos, 1.0);
+}
+)";
+
+constexpr const char *kFragmentShader = R"(#version 330 core
+in vec4 v_color;
+out vec4 o_color;
+
+void main() { o_color = v_color; }
+)";
+
+Vec3 sub(const Vec3 &a, const Vec3 &b) { return {a[0] - b[0], a[1] - b[1], a[2] - b[2]}; }
+float dot(const Vec3 &a, const Vec3 &b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+Vec3 cross(const Vec3 &a, const Vec3 &b) {
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+Vec3 normalize(const Vec3 &v) {
+  const float len = std::sqrt(dot(v, v));
+  return len > 1e-6F ? Vec3{v[0] / len, v[1] / len, v[2] / len} : Vec3{0.0F, 0.0F, 1.0F};
+}
+
+Mat4 multiply(const Mat4 &a, const Mat4 &b) {
+  Mat4 out{};
+  for (int c = 0; c < 4; ++c) {
+    for (int r = 0; r < 4; ++r) {
+      float sum = 0.0F;
+      for (int k = 0; k < 4; ++k) sum += a[k * 4 + r] * b[c * 4 + k];
+      out[c * 4 + r] = sum;
+    }
+  }
+  return out;
+}
+
+Mat4 perspective(float fovy, float aspect, float near_z, float far_z) {
+  const float f = 1.0F / std::tan(fovy * 0.5F);
+  Mat4 m{};
+  m[0] = f / aspect;
+  m[5] = f;
+  m[10] = (far_z + near_z) / (near_z - far_z);
+  m[11] = -1.0F;
+  m[14] = 2.0F * far_z * near_z / (near_z - far_z);
+  return m;
+}
+
+// z is up, as in the telemetry frame.
+Mat4 look_at(const Vec3 &eye, const Vec3 &target) {
+  const Vec3 f = normalize(sub(target, eye));
+  const Vec3 s = normalize(cross(f, {0.0F, 0.0F, 1.0F}));
+  const Vec3 u = cross(s, f);
+  Mat4 m{};
+  m[0] = s[0], m[4] = s[1], m[8] = s[2];
+  m[1] = u[0], m[5] = u[1], m[9] = u[2];
+  m[2] = -f[0], m[6] = -f[1], m[10] = -f[2];
+  m[12] = -dot(s, eye);
+  m[13] = -dot(u, eye);
+  m[14] = dot(f, eye);
+  m[15] = 1.0F;
+  return m;
+}
+
+// Rotates v by the unit quaternion q = (w, x, y, z).
+Vec3 rotate(const std::array<float, 4> &q, const Vec3 &v) {
+  const Vec3 u{q[1], q[2], q[3]};
+  const Vec3 t = cross(u, v);
+  const Vec3 t2{2.0F * t[0], 2.0F * t[1], 2.0F * t[2]};
+  const Vec3 c = cross(u, t2);
+  return {v[0] + q[0] * t2[0] + c[0], v[1] + q[0] * t2[1] + c[1], v[2] + q[0] * t2[2] + c[2]};
+}
+
+bool same_view(const GlSceneRenderer::Drone &a, const GlSceneRenderer::Drone &b) {
+  return a.id == b.id && a.color == b.color && a.pos == b.pos && a.quat == b.quat &&
+         a.hover == b.hover && a.fence_enabled == b.fence_enabled &&
+         a.fence_min == b.fence_min && a.fence_max == b.fence_max;
+}
+
+void push_line(std::vector<float> &out, const Vec3 &a, const Vec3 &b, ImU32 color) {
+  const ImVec4 c = ImGui::ColorConvertU32ToFloat4(color);
+  for (const auto &p : {a, b}) {
+    out.insert(out.end(), {p[0], p[1], p[2], c.x, c.y, c.z, c.w});
+  }
+}
+} // namespace
+
+bool GlSceneRenderer::init() {
+  if (ready()) return true;
+  if (!gl.load()) return false;
+  const GLuint program = gl_build_program("GL scene renderer", kVertexShader, kFragmentShader);
+  if (program == 0) return false;
+  program_ = program;
+  u_mvp_ = gl.GetUniformLocation(program_, "u_mvp");
+  gl.GenVertexArrays(1, &vao_);
+  gl.GenBuffers(1, &scratch_vbo_);
+  spdlog::info("GL scene renderer ready");
+  return true;
+}
+
+void GlSceneRenderer::shutdown() {
+  if (!ready()) return;
+  for (auto &[id, trail] : trails_) {
+    if (trail.vbo != 0) gl.DeleteBuffers(1, &trail.vbo);
+  }
+  trails_.clear();
+  if (fbo_ != 0) {
+    gl.DeleteFramebuffers(1, &fbo_);
+    gl.DeleteRenderbuffers(1, &depth_rb_);
+    glDeleteTextures(1, &color_tex_);
+  }
+  gl.DeleteBuffers(1, &scratch_vbo_);
+  gl.DeleteVertexArrays(1, &vao_);
+  gl.DeleteProgram(program_);
+  fbo_ = depth_rb_ = color_tex_ = scratch_vbo_ = vao_ = program_ = 0;
+  fb_w_ = fb_h_ = 0;
+}
+
+bool GlSceneRenderer::resize_target(const int width, const int height) {
+  if (fbo_ != 0 && width == fb_w_ && height == fb_h_) return false;
+  if (fbo_ == 0) {
+    gl.GenFramebuffers(1, &fbo_);
+    gl.GenRenderbuffers(1, &depth_rb_);
+    glGenTextures(1, &color_tex_);
+  }
+  glBindTexture(GL_TEXTURE_2D, color_tex_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  gl.BindRenderbuffer(GL_RENDERBUFFER, depth_rb_);
+  gl.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+  gl.BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  GLint prev_fbo = 0;
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+  gl.BindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_tex_, 0);
+  gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rb_);
+  const GLenum status = gl.CheckFramebufferStatus(GL_FRAMEBUFFER);
+  gl.BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prev_fbo));
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    spdlog::error("GL scene renderer: framebuffer incomplete (0x{:x})", status);
+    gl.DeleteFramebuffers(1, &fbo_);
+    gl.DeleteRenderbuffers(1, &depth_rb_);
+    glDeleteTextures(1, &color_tex_);
+    fbo_ = depth_rb_ = color_tex_ = 0;
+    fb_w_ = fb_h_ = 0;
+    return false;
+  }
+  fb_w_ = width;
+  fb_h_ = height;
+  return true;
+}
+
+bool GlSceneRenderer::upload_trail(Trail &trail, const TelemetryRing &ring) {
+  const uint64_t pushed = ring.pushed();
+  const size_t count = ring.size(ChannelId::POS_X);
+  const bool full = trail.vbo == 0 || trail.capacity != ring.capacity() ||
+                    pushed < trail.uploaded || count < trail.size;
+  const size_t fresh =
+      full ? count : static_cast<size_t>(std::min<uint64_t>(pushed - trail.uploaded, count));
+  trail.uploaded = pushed;
+  if (fresh == 0 && !full) return false;
+
+  if (trail.vbo == 0) gl.GenBuffers(1, &trail.vbo);
+  gl.BindBuffer(GL_ARRAY_BUFFER, trail.vbo);
+  if (full) {
+    trail.capacity = ring.capacity();
+    gl.BufferData(GL_ARRAY_BUFFER,
+                  static_cast<GLsizeiptr>((trail.capacity + 1) * kTrailFloats * sizeof(float)),
+                  nullptr, GL_DYNAMIC_DRAW);
+  }
+  const auto xs = ring.channel(ChannelId::POS_X);
+  const auto ys = ring.channel(ChannelId::POS_Y);
+  const auto zs = ring.channel(ChannelId::POS_Z);
+  staging_.resize(fresh * kTrailFloats);
+  for (size_t i = 0; i < fresh; ++i) {
+    const size_t idx = count - fresh + i;
+    staging_[i * kTrailFloats] = xs[idx];
+    staging_[i * kTrailFloats + 1] = ys[idx];
+    staging_[i * kTrailFloats + 2] = zs[idx];
+  }
+  gl_write_ring_slots(pushed, trail.capacity, fresh, staging_.data(), kTrailFloats);
+  gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+  trail.size = count;
+  return true;
+}
+
+void GlSceneRenderer::build_scratch(const std::vector<Drone> &drones) {
+  scratch_.clear();
+
+  // Ground grid around the camera target, coarser when zoomed out.
+  const float step = camera_.distance > 60.0F ? 5.0F : 1.0F;
+  const int half = static_cast<int>(std::clamp(camera_.distance, 10.0F, 200.0F) / step);
+  const float cx = std::round(camera_.target[0] / step) * step;
+  const float cy = std::round(camera_.target[1] / step) * step;
+  const float extent = static_cast<float>(half) * step;
+  for (int i = -half; i <= half; ++i) {
+    const float o = static_cast<float>(i) * step;
+    push_line(scratch_, {cx + o, cy - extent, 0.0F}, {cx + o, cy + extent, 0.0F},
+              IM_COL32(55, 55, 65, 255));
+    push_line(scratch_, {cx - extent, cy + o, 0.0F}, {cx + extent, cy + o, 0.0F},
+              IM_COL32(55, 55, 65, 255));
+  }
+
+  for (const auto &drone : drones) {
+    if (drone.fence_enabled) {
+      const Vec3 &lo = drone.fence_min;
+      const Vec3 &hi = drone.fence_max;
+      const ImU32 fence = IM_COL32(255, 120, 60, 170);
+      for (int a = 0; a < 3; ++a) {
+        // The four box edges parallel to axis a.
+        const int b = (a + 1) % 3;
+        const int c = (a + 2) % 3;
+        for (int corner = 0; corner < 4; ++corner) {
+          Vec3 p0{};
+          p0[b] = (corner & 1) ? hi[b] : lo[b];
+          p0[c] = (corner & 2) ? hi[c] : lo[c];
+          Vec3 p1 = p0;
+          p0[a] = lo[a];
+          p1[a] = hi[a];
+          push_line(scratch_, p0, p1, fence);
+        }
+      }
+    }
+
+    static constexpr ImU32 kAxisColors[] = {IM_COL32(255, 80, 80, 255),
+                                            IM_COL32(80, 220, 80, 255),
+                                            IM_COL32(80, 140, 255, 255)};
+    for (int a = 0; a < 3; ++a) {
+      Vec3 axis{};
+      axis[a] = kTriadLength;
+      const Vec3 d = rotate(drone.quat, axis);
+      push_line(scratch_, drone.pos,
+                {drone.pos[0] + d[0], drone.pos[1] + d[1], drone.pos[2] + d[2]},
+                kAxisColors[a]);
+    }
+
+    if (drone.hover) {
+      const Vec3 &h = *drone.hover;
+      for (int a = 0; a < 3; ++a) {
+        Vec3 p0 = h;
+        Vec3 p1 = h;
+        p0[a] -= kHoverMark;
+        p1[a] += kHoverMark;
+        push_line(scratch_, p0, p1, drone.color);
+      }
+      push_line(scratch_, drone.pos, h, (drone.color & ~IM_COL32_A_MASK) | IM_COL32(0, 0, 0, 90));
+    }
+  }
+}
+
+ImTextureID GlSceneRenderer::render(const ImVec2 size, const Camera &camera,
+                                    const std::vector<Drone> &drones) {
+  if (!ready() || size.x < 1.0F || size.y < 1.0F) return ImTextureID{};
+  const ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+  bool dirty = resize_target(std::max(1, static_cast<int>(size.x * scale.x)),
+                             std::max(1, static_cast<int>(size.y * scale.y)));
+  if (fbo_ == 0) return ImTextureID{};
+  for (const auto &drone : drones) {
+    if (drone.trail != nullptr) dirty |= upload_trail(trails_[drone.id], *drone.trail);
+  }
+  dirty = dirty || camera != camera_ || size.x != size_.x || size.y != size_.y ||
+          drones.size() != drones_.size() ||
+          !std::equal(drones.begin(), drones.end(), drones_.begin(), same_view);
+  const auto texture = (ImTextureID)(intptr_t)color_tex_;
+  if (!dirty) return texture;
+
+  // drones_ keeps the trail pointers only for comparison; never dereferenced.
+  size_ = size;
+  camera_ = camera;
+  drones_ = drones;
+  const float cp = std::cos(camera.pitch);
+  const Vec3 eye{camera.target[0] + camera.distance * cp * std::cos(camera.yaw),
+                 camera.target[1] + camera.distance * cp * std::sin(camera.yaw),
+                 camera.target[2] + camera.distance * std::sin(camera.pitch)};
+  mvp_ = multiply(perspective(0.8F, size.x / size.y, 0.1F, 2000.0F),
+                  look_at(eye, camera.target));
+
+  build_scratch(drones);
+  gl.BindBuffer(GL_ARRAY_BUFFER, scratch_vbo_);
+  gl.BufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(scratch_.size() * sizeof(float)),
+                scratch_.data(), GL_DYNAMIC_DRAW);
+
+  GLint prev_fbo = 0;
+  GLint prev_viewport[4] = {};
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+  glGetIntegerv(GL_VIEWPORT, prev_viewport);
+  const bool prev_depth = glIsEnabled(GL_DEPTH_TEST) != 0;
+  const bool prev_blend = glIsEnabled(GL_BLEND) != 0;
+  const bool prev_scissor = glIsEnabled(GL_SCISSOR_TEST) != 0;
+
+  gl.BindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glViewport(0, 0, fb_w_, fb_h_);
+  glDisable(GL_SCISSOR_TEST);
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glClearColor(0.08F, 0.08F, 0.095F, 1.0F);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  gl.UseProgram(program_);
+  gl.UniformMatrix4fv(u_mvp_, 1, GL_FALSE, mvp_.data());
+  gl.BindVertexArray(vao_);
+
+  const auto scratch_stride = static_cast<GLsizei>(kScratchFloats * sizeof(float));
+  gl.EnableVertexAttribArray(0);
+  gl.EnableVertexAttribArray(1);
+  gl.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, scratch_stride, nullptr);
+  gl.VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, scratch_stride,
+                         reinterpret_cast<const void *>(3 * sizeof(float)));
+  glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(scratch_.size() / kScratchFloats));
+
+  // Trails take their color from the constant attribute.
+  gl.DisableVertexAttribArray(1);
+  for (const auto &drone : drones) {
+    const auto it = trails_.find(drone.id);
+    if (drone.trail == nullptr || it == trails_.end() || it->second.size < 2) continue;
+    const Trail &trail = it->second;
+    const ImVec4 c = ImGui::ColorConvertU32ToFloat4(drone.color);
+    gl.VertexAttrib4f(1, c.x, c.y, c.z, 0.8F);
+    gl.BindBuffer(GL_ARRAY_BUFFER, trail.vbo);
+    gl.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                           static_cast<GLsizei>(kTrailFloats * sizeof(float)), nullptr);
+    const size_t oldest = static_cast<size_t>((trail.uploaded - trail.size) % trail.capacity);
+    const size_t head = std::min(trail.size, trail.capacity - oldest);
+    if (trail.size > head) {
+      // Through the mirror slot, then on from slot 0.
+      glDrawArrays(GL_LINE_STRIP, static_cast<GLint>(oldest), static_cast<GLsizei>(head + 1));
+      glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(trail.size - head));
+    } else {
+      glDrawArrays(GL_LINE_STRIP, static_cast<GLint>(oldest), static_cast<GLsizei>(head));
+    }
+  }
+
+  gl.BindVertexArray(0);
+  gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+  gl.UseProgram(0);
+  gl.BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prev_fbo));
+  glViewport(prev_viewport[0], prev_viewport[1], prev_viewport[2], prev_viewport[3]);
+  if (!prev_depth) glDisable(GL_DEPTH_TEST);
+  if (!prev_blend) glDisable(GL_BLEND);
+  if (prev_scissor) glEnable(GL_SCISSOR_TEST);
+  return texture;
+}
+
+std::optional<ImVec2> GlSceneRenderer::project(const std::array<float, 3> &p) const {
+  const Mat4 &m = mvp_;
+  const float x = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+  const float y = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+  const float w = m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15];
+  if (w <= 1e-4F) return std::nullopt;
+  return ImVec2((x / w + 1.0F) * 0.5F * size_.x, (1.0F - y / w) * 0.5F * size_.y);
+}
+
+} // namespace ui
+} // namespace px4ctrl
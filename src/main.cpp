@@ -8,7 +8,9 @@
 #endif
 #include <GLFW/glfw3.h> // Will drag system OpenGL headers
 
+#include <algorithm>
 #include <csignal>
+#include <iterator>
 #include <iostream>
 #include <spdlog/logger.h>
 #include <spdlog/spdlog.h>
@@ -23,6 +25,24 @@ static void glfw_error_callback(int error, const char* description)
 }
 
 
+// First connected gamepad with a standard mapping, if any.
+static px4ctrl::ui::GamepadSample sample_gamepad()
+{
+    px4ctrl::ui::GamepadSample sample;
+    for (int jid = GLFW_JOYSTICK_1; jid <= GLFW_JOYSTICK_LAST; ++jid) {
+        GLFWgamepadstate state;
+        if (!glfwJoystickIsGamepad(jid) || !glfwGetGamepadState(jid, &state))
+            continue;
+        sample.connected = true;
+        if (const char* name = glfwGetGamepadName(jid))
+            sample.name = name;
+        std::copy(std::begin(state.axes), std::end(state.axes), sample.axes.begin());
+        std::copy(std::begin(state.buttons), std::end(state.buttons), sample.buttons.begin());
+        break;
+    }
+    return sample;
+}
+
 void sigintHandler( int sig ) {
     spdlog::info( "[px4ctrl_gcs] exit..." );
     // close
@@ -96,6 +116,12 @@ int main(int argc, char* argv[]){
     px4ctrl::ui::TransportParas paras = px4ctrl::ui::TransportParas::load(config_file);
     px4ctrl::ui::Px4Client px4_client(paras);
     px4ctrl::ui::ImguiClient imgui_client(px4_client);
+    if (!imgui_client.init_gl()) {
+        spdlog::warn("OpenGL 3.3 renderers unavailable: ImGui line plots, no 3D view");
+    }
+    // Redraw on input, new telemetry or deadlines instead of spinning
+    px4ctrl::ui::RedrawScheduler& redraw = imgui_client.redraw();
+    redraw.set_wake(glfwPostEmptyEvent);
 
     //clear_color = Imgui background color
     ImVec4 clear_color = ImGui::GetStyleColorVec4(ImGuiCol_WindowBg);
@@ -107,6 +133,7 @@ int main(int argc, char* argv[]){
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
         // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or clear/overwrite your copy of the keyboard data.
         // Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
+        redraw.wait([](double timeout) { glfwWaitEventsTimeout(timeout); });
         glfwPollEvents();
 
         // Start the Dear ImGui frame
@@ -119,6 +146,9 @@ int main(int argc, char* argv[]){
         ImGui::SetNextWindowPos(ImVec2(0, 0));
 
         //render window
+        imgui_client.set_window_visible(glfwGetWindowAttrib(window, GLFW_ICONIFIED) == 0 &&
+                                        glfwGetWindowAttrib(window, GLFW_VISIBLE) != 0);
+        imgui_client.set_gamepad(sample_gamepad());
         imgui_client.render_window();
 
         // Rendering
@@ -130,8 +160,13 @@ int main(int argc, char* argv[]){
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         glfwSwapBuffers(window);
+        redraw.frame_presented();
     }
     // Cleanup
+    // Observers keep running until px4_client goes; this also waits out a
+    // glfwPostEmptyEvent already in flight on a worker.
+    redraw.set_wake(nullptr);
+    imgui_client.shutdown_gl();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();